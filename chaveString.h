@@ -0,0 +1,146 @@
+/*
+  chaveString.h — chaves de texto com metadados pré-calculados
+  Usado pelos nomes da mochila/torre (Free Fire) e pelas pistas e salas
+  do Detective Quest.
+  Cada chave guarda, ao lado dos bytes, o comprimento, um hash e os
+  8 primeiros bytes em big-endian:
+  - igualdade rejeita por hash/comprimento antes de olhar o texto
+  - ordenação compara o prefixo como inteiro e só usa strcmp no restante
+    quando os 8 primeiros bytes empatam
+  O hash lê 8 bytes por vez (no estilo do wyhash) e usa uma semente que
+  pode ser sorteada por processo com definirSementeChave(), antes de criar
+  qualquer chave, para dificultar colisões provocadas de propósito.
+*/
+#ifndef CHAVE_STRING_H
+#define CHAVE_STRING_H
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+    uint64_t prefixo; // 8 primeiros bytes (zeros após o fim), big-endian
+    uint32_t hash;    // hash do texto completo
+    uint32_t len;     // strlen do texto
+} MetaChave;
+
+// Declara uma chave com capacidade fixa (incluindo o '\0')
+#define CHAVE_STRING(CAPACIDADE) struct { MetaChave meta; char texto[CAPACIDADE]; }
+
+// Atalhos para chaves declaradas com CHAVE_STRING
+#define DEFINIR_CHAVE(chave, origem) \
+    definirChave(&(chave).meta, (chave).texto, sizeof((chave).texto), (origem))
+#define CHAVES_IGUAIS(a, b) chavesIguais(&(a).meta, (a).texto, &(b).meta, (b).texto)
+#define COMPARAR_CHAVES(a, b) compararChaves(&(a).meta, (a).texto, &(b).meta, (b).texto)
+
+// Prefixo de 8 bytes: comparar os inteiros equivale a strcmp nesses bytes
+static inline uint64_t prefixoChave(const char *s) {
+    uint64_t p = 0;
+    int fim = 0;
+    for (int i = 0; i < 8; i++) {
+        unsigned char c = fim ? 0 : (unsigned char)s[i];
+        if (c == '\0') fim = 1;
+        p = (p << 8) | c;
+    }
+    return p;
+}
+
+/* -------------------------
+   Hash com semente, 8 bytes por iteração
+   -------------------------*/
+
+#define CHAVE_SEMENTE_PADRAO 0x243f6a8885a308d3ULL
+#define CHAVE_SEGREDO_0 0xa0761d6478bd642fULL
+#define CHAVE_SEGREDO_1 0xe7037ed1a0b428dbULL
+
+// Estado do hash com ligação interna: cada unidade de tradução que inclui
+// este cabeçalho tem a sua própria semente. Serve aos programas de arquivo
+// único deste repositório; um programa com vários .c deve chamar
+// definirSementeChave() em cada um ou passar a semente para um único .c.
+static uint64_t sementeChave = CHAVE_SEMENTE_PADRAO;
+
+// Multiplicação 64x64 -> 128 bits dobrada em 64 (mistura forte e barata)
+static inline uint64_t misturarChave(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    uint64_t ha = a >> 32, la = (uint32_t)a, hb = b >> 32, lb = (uint32_t)b;
+    uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+    uint64_t meio = (ll >> 32) + (uint32_t)hl + (uint32_t)lh;
+    uint64_t lo = (ll & 0xffffffffULL) | (meio << 32);
+    uint64_t hi = hh + (hl >> 32) + (lh >> 32) + (meio >> 32);
+    return lo ^ hi;
+#endif
+}
+
+static inline uint64_t ler64Chave(const char *p) { uint64_t v; memcpy(&v, p, 8); return v; }
+static inline uint64_t ler32Chave(const char *p) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+// Deve ser chamada antes de qualquer chave ser criada (os hashes ficam guardados)
+static inline void definirSementeChave(uint64_t semente) {
+    sementeChave = misturarChave(semente ^ CHAVE_SEGREDO_0, CHAVE_SEGREDO_1);
+}
+
+static inline uint32_t hashTextoChave(const char *s, size_t len) {
+    uint64_t semente = sementeChave, a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            size_t meio = (len >> 3) << 2; // 0 ou 4: cobre os bytes do meio
+            a = (ler32Chave(s) << 32) | ler32Chave(s + meio);
+            b = (ler32Chave(s + len - 4) << 32) | ler32Chave(s + len - 4 - meio);
+        } else if (len > 0) {
+            a = ((uint64_t)(unsigned char)s[0] << 16) | ((uint64_t)(unsigned char)s[len >> 1] << 8) |
+                (unsigned char)s[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        const char *p = s;
+        size_t resto = len;
+        while (resto > 16) {
+            semente = misturarChave(ler64Chave(p) ^ CHAVE_SEGREDO_1, ler64Chave(p + 8) ^ semente);
+            p += 16;
+            resto -= 16;
+        }
+        // últimos 16 bytes (podem sobrepor o bloco anterior)
+        a = ler64Chave(p + resto - 16);
+        b = ler64Chave(p + resto - 8);
+    }
+    uint64_t h = misturarChave(CHAVE_SEGREDO_1 ^ len, misturarChave(a ^ CHAVE_SEGREDO_1, b ^ semente));
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+// Calcula os metadados de um texto (usado também para chaves de consulta)
+static inline void preencherMetaChave(MetaChave *m, const char *texto) {
+    size_t len = strlen(texto);
+    m->len = (uint32_t)len;
+    m->hash = hashTextoChave(texto, len);
+    m->prefixo = prefixoChave(texto);
+}
+
+// Copia 'origem' para 'texto' (truncando em cap-1) e calcula os metadados
+static inline void definirChave(MetaChave *m, char *texto, size_t cap, const char *origem) {
+    size_t len = strlen(origem);
+    if (len > cap - 1) len = cap - 1;
+    memcpy(texto, origem, len);
+    texto[len] = '\0';
+    m->len = (uint32_t)len;
+    m->hash = hashTextoChave(texto, len);
+    m->prefixo = prefixoChave(texto);
+}
+
+static inline int chavesIguais(const MetaChave *a, const char *ta, const MetaChave *b, const char *tb) {
+    if (a->hash != b->hash || a->len != b->len || a->prefixo != b->prefixo) return 0;
+    return a->len <= 8 || memcmp(ta + 8, tb + 8, a->len - 8) == 0;
+}
+
+// Mesma ordem de strcmp (<0, 0, >0)
+static inline int compararChaves(const MetaChave *a, const char *ta, const MetaChave *b, const char *tb) {
+    if (a->prefixo != b->prefixo) return a->prefixo < b->prefixo ? -1 : 1;
+    // prefixos iguais: se algum texto acaba antes de 8 bytes, ambos acabam no mesmo ponto
+    if (a->len < 8 || b->len < 8) return 0;
+    return strcmp(ta + 8, tb + 8);
+}
+
+#endif // CHAVE_STRING_H
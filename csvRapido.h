@@ -0,0 +1,224 @@
+/*
+  csvRapido.h — leitura e escrita rápidas de CSV simples
+  Usado pelos módulos da mochila e da torre de resgate (Free Fire) e pelo
+  carregador de mansões do Detective Quest.
+  - o arquivo inteiro é lido com um único fread para um buffer
+  - as linhas e os campos são quebrados no próprio buffer (sem cópias)
+  - a escrita acumula em um buffer grande e faz poucos fwrite
+  Formato aceito: campos separados por ','; um campo entre aspas pode conter
+  ',' e '""' (uma aspa literal), mas não quebras de linha; '\r\n' ou '\n';
+  linhas vazias são ignoradas. A escrita põe aspas só nos campos que precisam.
+*/
+#ifndef CSV_RAPIDO_H
+#define CSV_RAPIDO_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#define CSV_BUFFER_ESCRITA (1 << 20) // 1 MiB por fwrite
+
+/* -------------------------
+   Leitura
+   -------------------------*/
+
+typedef struct {
+    char *dados;     // conteúdo completo do arquivo, terminado em '\0'
+    size_t tamanho;
+    size_t pos;      // início da próxima linha
+    long linha;      // número da última linha lida (para mensagens)
+    long linhasDados; // linhas não vazias devolvidas até agora
+} LeitorCSV;
+
+// Lê o arquivo inteiro para memória. Retorna 1 em sucesso, 0 em erro.
+static int abrirLeitorCSV(LeitorCSV *l, const char *caminho) {
+    l->dados = NULL;
+    l->tamanho = l->pos = 0;
+    l->linha = l->linhasDados = 0;
+
+    FILE *f = fopen(caminho, "rb");
+    if (!f) return 0;
+    if (fseek(f, 0, SEEK_END) != 0) { fclose(f); return 0; }
+    long tam = ftell(f);
+    if (tam < 0 || fseek(f, 0, SEEK_SET) != 0) { fclose(f); return 0; }
+
+    l->dados = (char*) malloc((size_t)tam + 1);
+    if (!l->dados) { fclose(f); return 0; }
+    l->tamanho = fread(l->dados, 1, (size_t)tam, f);
+    l->dados[l->tamanho] = '\0';
+    fclose(f);
+    return 1;
+}
+
+static void fecharLeitorCSV(LeitorCSV *l) {
+    free(l->dados);
+    l->dados = NULL;
+    l->tamanho = l->pos = 0;
+}
+
+/*
+  Avança para a próxima linha não vazia e separa seus campos em 'campos'.
+  Retorna o número total de campos da linha (pode ser maior que maxCampos;
+  só os primeiros maxCampos são guardados) ou -1 no fim do arquivo.
+*/
+static int proximaLinhaCSV(LeitorCSV *l, char *campos[], int maxCampos) {
+    while (l->pos < l->tamanho) {
+        char *inicio = l->dados + l->pos;
+        char *fim = (char*) memchr(inicio, '\n', l->tamanho - l->pos);
+        if (!fim) fim = l->dados + l->tamanho;
+        l->pos = (size_t)(fim - l->dados) + 1;
+        l->linha++;
+
+        *fim = '\0';
+        if (fim > inicio && fim[-1] == '\r') fim[-1] = '\0';
+        if (*inicio == '\0') continue; // linha vazia
+        l->linhasDados++;
+
+        // cada campo é reescrito no próprio lugar (tirar as aspas só encurta)
+        int n = 0;
+        char *c = inicio;
+        for (;;) {
+            char *campo = c, *dst = c;
+            if (*c == '"') { // entre aspas: ',' vale como texto e "" vira "
+                for (c++; *c && !(*c == '"' && c[1] != '"'); c++) {
+                    if (*c == '"') c++;
+                    *dst++ = *c;
+                }
+                if (*c == '"') c++;
+            }
+            while (*c && *c != ',') *dst++ = *c++;
+            int fimLinha = *c == '\0';
+            *dst = '\0';
+            if (n < maxCampos) campos[n] = campo;
+            n++;
+            if (fimLinha) return n;
+            c++;
+        }
+    }
+    return -1;
+}
+
+/*
+  Converte um campo para inteiro de forma estrita: sinal opcional seguido
+  apenas de dígitos (até 9). Retorna 1 em sucesso, 0 se o campo for inválido.
+*/
+static int converterInteiroCSV(const char *s, int *valor) {
+    int negativo = 0, digitos = 0, v = 0;
+    if (*s == '-' || *s == '+') negativo = (*s++ == '-');
+    while (*s >= '0' && *s <= '9') {
+        if (++digitos > 9) return 0;
+        v = v * 10 + (*s++ - '0');
+    }
+    if (digitos == 0 || *s != '\0') return 0;
+    *valor = negativo ? -v : v;
+    return 1;
+}
+
+// A primeira linha não vazia é o cabeçalho quando começa pelo campo "nome"
+static inline int cabecalhoCSV(const LeitorCSV *l, char *campos[], int n) {
+    return l->linhasDados == 1 && n > 0 && strcmp(campos[0], "nome") == 0;
+}
+
+/*
+  Valida uma linha no formato texto,texto,inteiro (nome,tipo,quantidade
+  da mochila; nome,tipo,prioridade da torre). Os textos não podem ser
+  vazios e precisam caber, com o '\0', em capTexto1 e capTexto2 bytes; o
+  inteiro precisa estar entre minimo e maximo. Retorna 1 se a linha for
+  válida, com o inteiro em 'valor'.
+*/
+static inline int validarRegistroCSV(char *campos[], int n, size_t capTexto1, size_t capTexto2,
+                                     int minimo, int maximo, int *valor) {
+    if (n != 3) return 0;
+    size_t len1 = strlen(campos[0]), len2 = strlen(campos[1]);
+    return len1 > 0 && len1 < capTexto1 && len2 > 0 && len2 < capTexto2 &&
+           converterInteiroCSV(campos[2], valor) && *valor >= minimo && *valor <= maximo;
+}
+
+/* -------------------------
+   Escrita
+   -------------------------*/
+
+typedef struct {
+    FILE *f;
+    char *buffer;
+    size_t usado;
+    int erro;
+} EscritorCSV;
+
+static int abrirEscritorCSV(EscritorCSV *e, const char *caminho) {
+    e->usado = 0;
+    e->erro = 0;
+    e->f = fopen(caminho, "wb");
+    if (!e->f) return 0;
+    e->buffer = (char*) malloc(CSV_BUFFER_ESCRITA);
+    if (!e->buffer) { fclose(e->f); e->f = NULL; return 0; }
+    return 1;
+}
+
+static void descarregarEscritorCSV(EscritorCSV *e) {
+    if (e->usado > 0 && fwrite(e->buffer, 1, e->usado, e->f) != e->usado) e->erro = 1;
+    e->usado = 0;
+}
+
+// Garante espaço para 'n' bytes no buffer (descarregando se preciso)
+static void reservarEscritorCSV(EscritorCSV *e, size_t n) {
+    if (e->usado + n > CSV_BUFFER_ESCRITA) descarregarEscritorCSV(e);
+}
+
+// Escreve 's' sem aspas (cabeçalhos e textos já no formato); 'separador' é ',' ou '\n' (0 para nenhum)
+static void escreverBrutoCSV(EscritorCSV *e, const char *s, char separador) {
+    size_t len = strlen(s);
+    if (len + 1 > CSV_BUFFER_ESCRITA) { // campo gigante: escreve direto
+        descarregarEscritorCSV(e);
+        if (fwrite(s, 1, len, e->f) != len) e->erro = 1;
+        len = 0;
+        s = "";
+    }
+    reservarEscritorCSV(e, len + 1);
+    memcpy(e->buffer + e->usado, s, len);
+    e->usado += len;
+    if (separador) e->buffer[e->usado++] = separador;
+}
+
+// Escreve um campo de texto, entre aspas se tiver ',' ou '"' (aspas internas dobradas)
+static void escreverTextoCSV(EscritorCSV *e, const char *s, char separador) {
+    if (!strpbrk(s, ",\"")) {
+        escreverBrutoCSV(e, s, separador);
+        return;
+    }
+    reservarEscritorCSV(e, 1);
+    e->buffer[e->usado++] = '"';
+    for (; *s; s++) {
+        reservarEscritorCSV(e, 2);
+        if (*s == '"') e->buffer[e->usado++] = '"';
+        e->buffer[e->usado++] = *s;
+    }
+    reservarEscritorCSV(e, 2);
+    e->buffer[e->usado++] = '"';
+    if (separador) e->buffer[e->usado++] = separador;
+}
+
+// Escreve um inteiro sem passar por printf
+static void escreverInteiroCSV(EscritorCSV *e, int v, char separador) {
+    char tmp[12];
+    int n = 0;
+    unsigned int u = v < 0 ? 0u - (unsigned int)v : (unsigned int)v;
+    do { tmp[n++] = (char)('0' + u % 10); u /= 10; } while (u);
+    reservarEscritorCSV(e, (size_t)n + 2);
+    if (v < 0) e->buffer[e->usado++] = '-';
+    while (n) e->buffer[e->usado++] = tmp[--n];
+    if (separador) e->buffer[e->usado++] = separador;
+}
+
+// Descarrega e fecha. Retorna 1 se tudo foi gravado, 0 em erro.
+static int fecharEscritorCSV(EscritorCSV *e) {
+    descarregarEscritorCSV(e);
+    if (fclose(e->f) != 0) e->erro = 1;
+    free(e->buffer);
+    e->f = NULL;
+    e->buffer = NULL;
+    return !e->erro;
+}
+
+#endif // CSV_RAPIDO_H
@@ -2,181 +2,1196 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>   // compilar com -pthread
+#include <sched.h>
+#include <stdatomic.h>
+#include "chaveString.h"
+#include "csvRapido.h"
 
 #define MAX_NOME 64
 #define MAX_PISTA 128
-#define HASH_SIZE 101   // tamanho da tabela hash (primo simples)
+#define HASH_CAPACIDADE_INICIAL 16 // potência de 2; dobra ao passar da carga máxima
+#define HASH_CARGA_MAX_NUM 4       // carga máxima = 4/5 = 0,8
+#define HASH_CARGA_MAX_DEN 5
+#define ARENA_CAPACIDADE_INICIAL 4096
+#define ALTURA_MAX_AVL 64 // altura de uma AVL com até 2^40 nós fica abaixo disso
+#define SEM_SALA -1       // índice de filho ausente na mansão
+#define LIMIAR_ACUSACAO 2 // pistas necessárias para sustentar uma acusação
+#define TRIGRAMAS_CAPACIDADE_INICIAL 1024 // potência de 2
 
 /* -------------------------
    Structs principais
    -------------------------*/
 
-// Nó da árvore binária que representa uma sala
-typedef struct sala {
-    char nome[MAX_NOME];
-    char pista[MAX_PISTA];     // pista associada à sala (pode ser string vazia)
-    struct sala *esquerda;
-    struct sala *direita;
+// Chaves de texto com comprimento, hash e prefixo pré-calculados (chaveString.h)
+typedef CHAVE_STRING(MAX_PISTA) ChavePista;
+
+// Nó da árvore binária que representa uma sala (filhos por índice)
+typedef struct {
+    uint32_t nome;             // deslocamento do nome em Mansao.textos
+    uint32_t pista;            // deslocamento da pista (0 = texto vazio, sem pista)
+    int32_t esquerda;          // índice em Mansao.salas ou SEM_SALA
+    int32_t direita;
 } Sala;
 
-// Nó da BST que guarda as pistas coletadas (ordenadas)
+// Mansão inteira em um só bloco: salas contíguas seguidas dos textos
+typedef struct {
+    Sala *salas;               // salas[0] é a entrada
+    int totalSalas;
+    char *textos;              // nomes e pistas terminados em '\0'
+    size_t usadoTextos;
+} Mansao;
+
+// Nó da árvore AVL que guarda as pistas coletadas (ordenadas, sem duplicatas)
 typedef struct pistaNode {
-    char pista[MAX_PISTA];
+    ChavePista pista;
+    int altura;                // altura da subárvore (folha = 1)
     struct pistaNode *esquerda;
     struct pistaNode *direita;
+    struct pistaNode *proximaDoSuspeito; // próxima pista coletada do mesmo suspeito
 } PistaNode;
 
-// Nó para tabela hash (encadeamento separado)
-typedef struct hashNode {
-    char chave[MAX_PISTA];     // a pista (chave)
-    char suspeito[MAX_NOME];   // valor: nome do suspeito
-    struct hashNode *next;
-} HashNode;
+// Índice de trigramas: trecho de 3 bytes -> lista de pistas que o contêm
+typedef struct {
+    uint32_t codigo;      // 3 bytes do trigrama + bit 24 (0 = posição vazia)
+    uint32_t primeira;    // primeira ocorrência em 'ocorrencias' (UINT32_MAX = nenhuma)
+    uint32_t total;       // tamanho da lista
+} EntradaTrigrama;
+
+typedef struct {
+    uint32_t pista;       // posição em ColecaoPistas.nos
+    uint32_t proxima;     // próxima ocorrência do mesmo trigrama
+} OcorrenciaTrigrama;
+
+typedef struct {
+    EntradaTrigrama *entradas;
+    size_t capacidade;    // potência de 2
+    size_t total;
+    OcorrenciaTrigrama *ocorrencias;
+    size_t totalOcorrencias;
+    size_t capOcorrencias;
+} IndiceTrigramas;
+
+// Pistas coletadas: AVL em ordem alfabética + índice para busca por trecho
+typedef struct {
+    PistaNode *raiz;
+    PistaNode **nos;      // pistas na ordem de coleta
+    int total;
+    int capacidade;
+    IndiceTrigramas trigramas;
+} ColecaoPistas;
+
+// Área contígua onde ficam os textos (chaves e valores) da tabela hash.
+// As entradas guardam deslocamentos, que continuam válidos após realloc.
+typedef struct {
+    char *dados;
+    size_t usado;
+    size_t capacidade;
+} ArenaTexto;
+
+// Posição de um índice hash (endereçamento aberto, Robin Hood)
+typedef struct {
+    MetaChave meta;       // hash/comprimento/prefixo do texto
+    uint32_t chave;       // deslocamento do texto na arena
+    uint32_t valor;       // posição do suspeito em TabelaHash.suspeitos (ou da sala)
+    uint32_t distancia;   // 1 + distância da posição ideal; 0 = posição vazia
+} EntradaHash;
+
+// Índice texto -> valor (suspeito ou sala), redimensionável
+typedef struct {
+    EntradaHash *entradas;
+    size_t capacidade;    // sempre potência de 2
+    size_t total;
+} IndiceHash;
+
+// Evidências de um suspeito, atualizadas a cada pista coletada
+typedef struct {
+    uint32_t nome;        // deslocamento do nome na arena
+    int totalPistas;      // pistas coletadas que apontam para ele
+    PistaNode *pistas;    // essas pistas, ligadas por proximaDoSuspeito
+} Suspeito;
+
+// Tabela hash pista -> suspeito, com os suspeitos indexados pelo nome
+typedef struct {
+    IndiceHash pistas;    // pista -> suspeito
+    IndiceHash nomes;     // nome do suspeito -> suspeito
+    Suspeito *suspeitos;
+    int totalSuspeitos;
+    int capacidadeSuspeitos;
+    ArenaTexto textos;
+} TabelaHash;
+
+// Nó da árvore radix de pistas: rótulo = trecho da arena da tabela hash
+typedef struct {
+    uint32_t rotulo;      // deslocamento do rótulo na arena
+    uint32_t tamanho;     // bytes do rótulo; bit 31 = uma pista termina aqui
+    uint32_t filho;       // primeiro filho (0 = nenhum; o nó 0 é a raiz)
+    uint32_t irmao;       // próximo irmão, em ordem crescente do primeiro byte
+} NoRadix;
+
+// Conjunto compacto de pistas: só índices e trechos da arena, sem cópias de texto
+typedef struct {
+    NoRadix *nos;
+    uint32_t total;
+    uint32_t capacidade;
+    uint32_t pistas;
+    TabelaHash *hash;     // dona da arena de textos
+} ArvoreRadix;
+
+#define BLOCO_LCA 32 // posições do percurso de Euler por bloco (bits de uma máscara)
+
+// Consultas de caminho na mansão: pai/profundidade + percurso de Euler em blocos
+typedef struct {
+    Mansao *mansao;
+    int32_t *pai;           // SEM_SALA na entrada e em salas inalcançáveis
+    int32_t *profundidade;  // movimentos desde a entrada (-1 = inalcançável)
+    int32_t *primeira;      // primeira posição de cada sala em 'euler'
+    int32_t *euler;         // salas na ordem do percurso de Euler
+    uint32_t *mascaras;     // por posição: mínimos do bloco até ela (pilha em bits)
+    int32_t *tabela;        // 'niveis' linhas de 'totalBlocos' salas (mínimo de cada bloco)
+    int tamanhoEuler;
+    int totalBlocos;
+    int niveis;
+    IndiceHash nomes;       // nome da sala -> sala
+    IndiceHash pistas;      // pista -> sala onde está
+} IndiceCaminhos;
 
 /* -------------------------
    Assinaturas das funções
    -------------------------*/
 
-// criarSala() – cria dinamicamente um cômodo.
-Sala* criarSala(const char *nome, const char *pista);
+// carregarMansao() – lê a descrição da mansão (salas e pistas -> suspeitos).
+int carregarMansao(Mansao *m, const char *caminho, TabelaHash *hash);
+int carregarMansaoPadrao(Mansao *m, TabelaHash *hash);
+void liberarMansao(Mansao *m);
+
+// construirIndiceCaminhos() – prepara as consultas de distância e caminho entre salas.
+void construirIndiceCaminhos(IndiceCaminhos *c, Mansao *m);
+int32_t localizarSala(IndiceCaminhos *c, const char *texto);
+int distanciaSalas(const IndiceCaminhos *c, int32_t a, int32_t b);
+void exibirCaminho(IndiceCaminhos *c, int32_t a, int32_t b);
+void liberarIndiceCaminhos(IndiceCaminhos *c);
 
 // explorarSalas() – navega pela árvore e ativa o sistema de pistas.
-void explorarSalas(Sala *raiz, PistaNode **bstPistas, HashNode *hash[]);
+void explorarSalas(Mansao *mansao, ColecaoPistas *pistas, TabelaHash *hash, IndiceCaminhos *caminhos);
+
+// inserirPista() / adicionarPista() – insere a pista coletada na árvore de pistas (AVL)
+// e no índice de trigramas; devolve o nó novo (NULL se já havia sido coletada).
+void inicializarColecao(ColecaoPistas *c);
+PistaNode* inserirPista(ColecaoPistas *c, const char *pista);
+PistaNode* inserirPistaChave(ColecaoPistas *c, const ChavePista *chave);
+void liberarColecao(ColecaoPistas *c);
 
-// inserirPista() / adicionarPista() – insere a pista coletada na árvore de pistas (BST).
-PistaNode* inserirPista(PistaNode *raiz, const char *pista);
+// buscarPistas() – pistas que começam com um prefixo ("Pe*") ou contêm um trecho.
+int buscarPistasPorPrefixo(PistaNode *raiz, const char *prefixo,
+                           void (*visitar)(PistaNode *no, void *contexto), void *contexto);
+int buscarPistasPorTrecho(ColecaoPistas *c, const char *trecho,
+                          void (*visitar)(PistaNode *no, void *contexto), void *contexto);
+int buscarPistas(ColecaoPistas *c, const char *consulta,
+                 void (*visitar)(PistaNode *no, void *contexto), void *contexto);
+
+// buscarPista() – procura uma pista já coletada (NULL se não houver).
+PistaNode* buscarPista(PistaNode *raiz, const char *pista);
+
+// percorrerPistas() – visita as pistas em ordem alfabética (iterativo).
+void percorrerPistas(PistaNode *raiz, void (*visitar)(PistaNode *no, void *contexto), void *contexto);
 
 // inserirNaHash() – insere associação pista/suspeito na tabela hash.
-void inserirNaHash(HashNode *hash[], const char *pista, const char *suspeito);
+void inserirNaHash(TabelaHash *hash, const char *pista, const char *suspeito);
 
 // encontrarSuspeito() – consulta o suspeito correspondente a uma pista.
-const char* encontrarSuspeito(HashNode *hash[], const char *pista);
+const char* encontrarSuspeito(TabelaHash *hash, const char *pista);
+const char* encontrarSuspeitoChave(TabelaHash *hash, const MetaChave *meta, const char *pista);
+
+// registrarPistaColetada() – soma a pista recém-coletada às evidências do seu suspeito.
+void registrarPistaColetada(TabelaHash *hash, PistaNode *no);
+
+// contarPistasPorSuspeito() – pistas coletadas contra um suspeito (O(1)).
+int contarPistasPorSuspeito(TabelaHash *hash, const char *nomeSuspeito);
+
+// exibirRankingSuspeitos() – lista os suspeitos do mais ao menos incriminado.
+void ordenarSuspeitosPorEvidencia(TabelaHash *hash, int ordem[]);
+void exibirRankingSuspeitos(TabelaHash *hash);
+
+// inserirPistaRadix() – conjunto compacto de pistas (textos na arena da tabela hash).
+void inicializarRadix(ArvoreRadix *a, TabelaHash *hash);
+int inserirPistaRadix(ArvoreRadix *a, const char *texto);
+int contemPistaRadix(ArvoreRadix *a, const char *texto);
+int percorrerRadix(ArvoreRadix *a, const char *prefixo,
+                   void (*visitar)(const char *texto, void *contexto), void *contexto);
+void relatorioMemoriaPistas(ColecaoPistas *colecao, TabelaHash *hash);
+void liberarRadix(ArvoreRadix *a);
 
 // exibirPistas() – imprime as pistas coletadas em ordem alfabética.
 void exibirPistas(PistaNode *raiz);
 
 // verificarSuspeitoFinal() – conduz à fase de julgamento final.
-void verificarSuspeitoFinal(PistaNode *pistasColetadas, HashNode *hash[]);
+void verificarSuspeitoFinal(PistaNode *pistasColetadas, TabelaHash *hash);
 
 // funções utilitárias
-unsigned long hashString(const char *str);
-void inicializarHash(HashNode *hash[]);
+void inicializarHash(TabelaHash *hash);
 void liberarBST(PistaNode *raiz);
-void liberarHash(HashNode *hash[]);
+void liberarHash(TabelaHash *hash);
+void liberarIndice(IndiceHash *indice);
 void toLowerStr(char *s);
+long long agoraNs(void);
 
 /* -------------------------
    Implementação
    -------------------------*/
 
-Sala* criarSala(const char *nome, const char *pista) {
-    Sala *nova = (Sala*) malloc(sizeof(Sala));
-    if (!nova) {
-        fprintf(stderr, "Erro: falha na alocação de memória para sala.\n");
-        exit(EXIT_FAILURE);
+/* -------------------------
+   Mansão: carregamento a partir de uma descrição
+   -------------------------
+   Formato (uma linha por registro, campos separados por ',', como em csvRapido.h):
+     sala,<nome>,<pista ou vazio>,<esquerda>,<direita>
+     suspeito,<pista>,<nome do suspeito>
+   As salas são numeradas pela ordem em que aparecem (a primeira, 0, é a
+   entrada); esquerda/direita são esses números, ou -1 quando não há
+   caminho. Um filho sempre tem número maior que o da sala de origem, o que
+   impede ciclos, e toda sala além da entrada tem exatamente uma sala de
+   origem, o que impede caminhos que se reencontram e salas inalcançáveis:
+   a mansão é sempre uma árvore com raiz na entrada.
+   Linhas começando com '#' são comentários.
+
+   O arquivo inteiro já está em memória (csvRapido.h), então o número de
+   linhas limita o de salas e o tamanho do arquivo limita o dos textos:
+   salas e textos saem de um único bloco, alocado uma vez e liberado com
+   um único free. */
+
+static const char MANSAO_PADRAO[] =
+    "# Mansão padrão do Detective Quest\n"
+    "sala,Hall de Entrada,Pegadas enluvadas no carpete,1,2\n"
+    "sala,Sala de Estar,Perfume caro com resíduo de pó,3,4\n"
+    "sala,Cozinha,Faca faltando no jogo de talheres,5,6\n"
+    "sala,Biblioteca,Página arrancada de um testamento,7,-1\n"
+    "sala,Jardim Interno,Terra fresca com impressão de sapato pequeno,-1,-1\n"
+    "sala,Despensa,Rótulo de veneno rasgado,-1,-1\n"
+    "sala,Área de Serviço,Toalha com manchas de óleo,-1,-1\n"
+    "sala,Sótão,Peça de roupa com bordado inicial 'M.',-1,-1\n"
+    "suspeito,Pegadas enluvadas no carpete,Mariana\n"
+    "suspeito,Perfume caro com resíduo de pó,Roberto\n"
+    "suspeito,Faca faltando no jogo de talheres,Carlos\n"
+    "suspeito,Página arrancada de um testamento,Mariana\n"
+    "suspeito,Terra fresca com impressão de sapato pequeno,Ana\n"
+    "suspeito,Rótulo de veneno rasgado,Carlos\n"
+    "suspeito,Toalha com manchas de óleo,Roberto\n"
+    "suspeito,Peça de roupa com bordado inicial 'M.',Mariana\n";
+
+// Copia 's' para o bloco de textos (o espaço já foi reservado)
+uint32_t guardarNaMansao(Mansao *m, const char *s) {
+    size_t len = strlen(s);
+    uint32_t desloc = (uint32_t)m->usadoTextos;
+    memcpy(m->textos + m->usadoTextos, s, len + 1);
+    m->usadoTextos += len + 1;
+    return desloc;
+}
+
+int carregarMansaoLeitor(Mansao *m, LeitorCSV *leitor, TabelaHash *hash) {
+    size_t linhas = 1;
+    for (const char *c = leitor->dados; (c = memchr(c, '\n', leitor->tamanho - (size_t)(c - leitor->dados))); c++)
+        linhas++;
+    if (linhas > INT32_MAX || leitor->tamanho >= UINT32_MAX) {
+        printf("Descrição da mansão grande demais.\n");
+        return 0;
     }
-    strncpy(nova->nome, nome, MAX_NOME-1);
-    nova->nome[MAX_NOME-1] = '\0';
 
-    if (pista != NULL) {
-        strncpy(nova->pista, pista, MAX_PISTA-1);
-        nova->pista[MAX_PISTA-1] = '\0';
-    } else {
-        nova->pista[0] = '\0';
+    size_t bytesSalas = linhas * sizeof(Sala);
+    char *bloco = (char*) malloc(bytesSalas + leitor->tamanho + 1);
+    if (!bloco) { fprintf(stderr, "Erro: malloc mansão\n"); exit(EXIT_FAILURE); }
+    m->salas = (Sala*) bloco;
+    m->totalSalas = 0;
+    m->textos = bloco + bytesSalas;
+    m->textos[0] = '\0'; // deslocamento 0 = texto vazio (sala sem pista)
+    m->usadoTextos = 1;
+
+    char *campos[5];
+    int n;
+    while ((n = proximaLinhaCSV(leitor, campos, 5)) >= 0) {
+        if (campos[0][0] == '#') continue;
+
+        int esquerda, direita;
+        if (n == 5 && strcmp(campos[0], "sala") == 0 && campos[1][0] != '\0' &&
+            strlen(campos[2]) < MAX_PISTA &&
+            converterInteiroCSV(campos[3], &esquerda) && esquerda >= SEM_SALA &&
+            converterInteiroCSV(campos[4], &direita) && direita >= SEM_SALA) {
+            Sala *s = &m->salas[m->totalSalas++];
+            s->nome = guardarNaMansao(m, campos[1]);
+            s->pista = campos[2][0] != '\0' ? guardarNaMansao(m, campos[2]) : 0;
+            s->esquerda = esquerda;
+            s->direita = direita;
+        } else if (n == 3 && strcmp(campos[0], "suspeito") == 0 && campos[1][0] != '\0' &&
+                   strlen(campos[1]) < MAX_PISTA && campos[2][0] != '\0' && strlen(campos[2]) < MAX_NOME) {
+            inserirNaHash(hash, campos[1], campos[2]);
+        } else {
+            printf("Linha %ld da mansão inválida.\n", leitor->linha);
+            liberarMansao(m);
+            return 0;
+        }
+    }
+
+    if (m->totalSalas == 0) {
+        printf("A mansão não tem nenhuma sala.\n");
+        liberarMansao(m);
+        return 0;
     }
-    nova->esquerda = nova->direita = NULL;
-    return nova;
+    // grau de entrada: marca cada sala já usada como filho
+    unsigned char *temPai = (unsigned char*) calloc((size_t)m->totalSalas, 1);
+    if (!temPai) { fprintf(stderr, "Erro: malloc mansão\n"); exit(EXIT_FAILURE); }
+    for (int i = 0; i < m->totalSalas; i++) {
+        int32_t filhos[2] = {m->salas[i].esquerda, m->salas[i].direita};
+        for (int k = 0; k < 2; k++) {
+            if (filhos[k] == SEM_SALA) continue;
+            if (filhos[k] <= i || filhos[k] >= m->totalSalas) {
+                printf("Sala %d aponta para uma sala inexistente ou anterior (%d).\n", i, (int)filhos[k]);
+            } else if (temPai[filhos[k]]) {
+                printf("Sala %d tem mais de uma sala de origem (a segunda é a sala %d).\n", (int)filhos[k], i);
+            } else {
+                temPai[filhos[k]] = 1;
+                continue;
+            }
+            free(temPai);
+            liberarMansao(m);
+            return 0;
+        }
+    }
+    for (int i = 1; i < m->totalSalas; i++) {
+        if (!temPai[i]) {
+            printf("Sala %d não tem sala de origem (seria inalcançável).\n", i);
+            free(temPai);
+            liberarMansao(m);
+            return 0;
+        }
+    }
+    free(temPai);
+    return 1;
+}
+
+int carregarMansao(Mansao *m, const char *caminho, TabelaHash *hash) {
+    LeitorCSV leitor;
+    if (!abrirLeitorCSV(&leitor, caminho)) {
+        printf("Não foi possível ler o arquivo \"%s\".\n", caminho);
+        return 0;
+    }
+    int ok = carregarMansaoLeitor(m, &leitor, hash);
+    fecharLeitorCSV(&leitor);
+    return ok;
+}
+
+int carregarMansaoPadrao(Mansao *m, TabelaHash *hash) {
+    LeitorCSV leitor;
+    leitor.tamanho = sizeof(MANSAO_PADRAO) - 1;
+    leitor.pos = 0;
+    leitor.linha = leitor.linhasDados = 0;
+    leitor.dados = (char*) malloc(leitor.tamanho + 1); // a leitura quebra os campos no próprio buffer
+    if (!leitor.dados) { fprintf(stderr, "Erro: malloc mansão\n"); exit(EXIT_FAILURE); }
+    memcpy(leitor.dados, MANSAO_PADRAO, leitor.tamanho + 1);
+    int ok = carregarMansaoLeitor(m, &leitor, hash);
+    fecharLeitorCSV(&leitor);
+    return ok;
 }
 
-/* BST: insere pista se não existir; retorna raiz (inserção recursiva)
-   Não insere duplicatas (comparação por strcmp). */
-PistaNode* inserirPista(PistaNode *raiz, const char *pista) {
-    if (pista == NULL || pista[0] == '\0') return raiz;
+void liberarMansao(Mansao *m) {
+    free(m->salas); // salas e textos estão no mesmo bloco
+    m->salas = NULL;
+    m->textos = NULL;
+    m->totalSalas = 0;
+    m->usadoTextos = 0;
+}
+
+/* -------------------------
+   Árvore AVL de pistas
+   -------------------------*/
+
+int alturaPista(PistaNode *n) {
+    return n ? n->altura : 0;
+}
 
-    if (raiz == NULL) {
-        PistaNode *n = (PistaNode*) malloc(sizeof(PistaNode));
-        if (!n) { fprintf(stderr, "Erro: malloc pista\n"); exit(EXIT_FAILURE); }
-        strncpy(n->pista, pista, MAX_PISTA-1);
-        n->pista[MAX_PISTA-1] = '\0';
-        n->esquerda = n->direita = NULL;
-        return n;
+void atualizarAlturaPista(PistaNode *n) {
+    int ae = alturaPista(n->esquerda), ad = alturaPista(n->direita);
+    n->altura = 1 + (ae > ad ? ae : ad);
+}
+
+PistaNode* rotacionarDireita(PistaNode *y) {
+    PistaNode *x = y->esquerda;
+    y->esquerda = x->direita;
+    x->direita = y;
+    atualizarAlturaPista(y);
+    atualizarAlturaPista(x);
+    return x;
+}
+
+PistaNode* rotacionarEsquerda(PistaNode *x) {
+    PistaNode *y = x->direita;
+    x->direita = y->esquerda;
+    y->esquerda = x;
+    atualizarAlturaPista(x);
+    atualizarAlturaPista(y);
+    return y;
+}
+
+// Recalcula a altura de 'n' e aplica a rotação simples/dupla necessária
+PistaNode* balancearPista(PistaNode *n) {
+    atualizarAlturaPista(n);
+    int fator = alturaPista(n->esquerda) - alturaPista(n->direita);
+    if (fator > 1) {
+        if (alturaPista(n->esquerda->esquerda) < alturaPista(n->esquerda->direita))
+            n->esquerda = rotacionarEsquerda(n->esquerda);
+        return rotacionarDireita(n);
+    }
+    if (fator < -1) {
+        if (alturaPista(n->direita->direita) < alturaPista(n->direita->esquerda))
+            n->direita = rotacionarDireita(n->direita);
+        return rotacionarEsquerda(n);
     }
+    return n;
+}
+
+/* AVL: insere pista se não existir (inserção iterativa).
+   Não insere duplicatas. A descida guarda os ponteiros de ligação visitados
+   e o rebalanceamento volta por eles até a altura parar de mudar.
+   A chave da pista é montada uma vez e comparada pelo prefixo de 8 bytes
+   (strcmp só no restante, em caso de empate).
+   Devolve o nó criado, ou NULL se a pista já estava na árvore. */
+PistaNode* inserirNaAVL(PistaNode **raiz, const ChavePista *chave) {
+    PistaNode **caminho[ALTURA_MAX_AVL];
+    int topo = 0;
+    PistaNode **ligacao = raiz;
+
+    while (*ligacao != NULL) {
+        int cmp = COMPARAR_CHAVES(*chave, (*ligacao)->pista);
+        if (cmp == 0) return NULL; // já coletada -> não insere duplicata
+        caminho[topo++] = ligacao;
+        ligacao = cmp < 0 ? &(*ligacao)->esquerda : &(*ligacao)->direita;
+    }
+
+    PistaNode *n = (PistaNode*) malloc(sizeof(PistaNode));
+    if (!n) { fprintf(stderr, "Erro: malloc pista\n"); exit(EXIT_FAILURE); }
+    n->pista = *chave;
+    n->altura = 1;
+    n->esquerda = n->direita = NULL;
+    n->proximaDoSuspeito = NULL;
+    *ligacao = n;
 
-    int cmp = strcmp(pista, raiz->pista);
-    if (cmp < 0) raiz->esquerda = inserirPista(raiz->esquerda, pista);
-    else if (cmp > 0) raiz->direita = inserirPista(raiz->direita, pista);
-    // se cmp == 0, já coletada -> não insere duplicata
-    return raiz;
+    while (topo > 0) {
+        ligacao = caminho[--topo];
+        int alturaAntes = (*ligacao)->altura;
+        *ligacao = balancearPista(*ligacao);
+        if ((*ligacao)->altura == alturaAntes) break; // ancestrais não mudam
+    }
+    return n;
 }
 
-/* Hash: djb2 */
-unsigned long hashString(const char *str) {
-    unsigned long hash = 5381;
-    int c;
-    while ((c = (unsigned char)*str++))
-        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
-    return hash % HASH_SIZE;
+/* -------------------------
+   Índice de trigramas (busca por trecho)
+   -------------------------
+   Cada trecho de 3 bytes de uma pista aponta para uma lista de ocorrências
+   (pista, próxima ocorrência) guardada em um único vetor. Uma busca por
+   "veneno" pega o trigrama mais raro do trecho e só confere com strstr as
+   pistas daquela lista. */
+
+// 3 bytes + bit 24 aceso (0 = posição vazia)
+static inline uint32_t codigoTrigrama(const char *s) {
+    return 0x1000000u | ((uint32_t)(unsigned char)s[0] << 16) |
+           ((uint32_t)(unsigned char)s[1] << 8) | (unsigned char)s[2];
 }
 
-void inicializarHash(HashNode *hash[]) {
-    for (int i = 0; i < HASH_SIZE; ++i) hash[i] = NULL;
+static inline size_t posicaoTrigrama(uint32_t codigo, size_t capacidade) {
+    return (size_t)((codigo * 0x9e3779b1u) >> 7) & (capacidade - 1);
 }
 
-void inserirNaHash(HashNode *hash[], const char *pista, const char *suspeito) {
-    if (!pista || pista[0] == '\0') return;
-    unsigned long h = hashString(pista);
-    // evita inserir duplicata de chave
-    for (HashNode *it = hash[h]; it != NULL; it = it->next) {
-        if (strcmp(it->chave, pista) == 0) {
-            // atualiza suspeito (não deve ocorrer em nosso uso, mas deixamos seguro)
-            strncpy(it->suspeito, suspeito, MAX_NOME-1);
-            it->suspeito[MAX_NOME-1] = '\0';
+void inicializarTrigramas(IndiceTrigramas *t) {
+    t->capacidade = TRIGRAMAS_CAPACIDADE_INICIAL;
+    t->total = 0;
+    t->entradas = (EntradaTrigrama*) calloc(t->capacidade, sizeof(EntradaTrigrama));
+    t->ocorrencias = NULL;
+    t->totalOcorrencias = t->capOcorrencias = 0;
+    if (!t->entradas) { fprintf(stderr, "Erro: malloc trigramas\n"); exit(EXIT_FAILURE); }
+}
+
+// Entrada do trigrama (vazia com codigo 0 se não existir)
+EntradaTrigrama* localizarTrigrama(IndiceTrigramas *t, uint32_t codigo) {
+    size_t mascara = t->capacidade - 1;
+    size_t i = posicaoTrigrama(codigo, t->capacidade);
+    while (t->entradas[i].codigo != 0 && t->entradas[i].codigo != codigo) i = (i + 1) & mascara;
+    return &t->entradas[i];
+}
+
+void redimensionarTrigramas(IndiceTrigramas *t) {
+    EntradaTrigrama *antigas = t->entradas;
+    size_t capAntiga = t->capacidade;
+    t->capacidade *= 2;
+    t->entradas = (EntradaTrigrama*) calloc(t->capacidade, sizeof(EntradaTrigrama));
+    if (!t->entradas) { fprintf(stderr, "Erro: malloc trigramas\n"); exit(EXIT_FAILURE); }
+    for (size_t i = 0; i < capAntiga; i++)
+        if (antigas[i].codigo != 0) *localizarTrigrama(t, antigas[i].codigo) = antigas[i];
+    free(antigas);
+}
+
+void indexarTrigramas(IndiceTrigramas *t, uint32_t pista, const char *texto, size_t len) {
+    for (size_t i = 0; i + 3 <= len; i++) {
+        uint32_t codigo = codigoTrigrama(texto + i);
+        EntradaTrigrama *e = localizarTrigrama(t, codigo);
+        if (e->codigo == 0) {
+            if ((t->total + 1) * 2 > t->capacidade) { // carga máxima 1/2
+                redimensionarTrigramas(t);
+                e = localizarTrigrama(t, codigo);
+            }
+            e->codigo = codigo;
+            e->primeira = UINT32_MAX;
+            e->total = 0;
+            t->total++;
+        }
+        // trigrama repetido na mesma pista: a lista já começa por ela
+        if (e->primeira != UINT32_MAX && t->ocorrencias[e->primeira].pista == pista) continue;
+
+        if (t->totalOcorrencias == t->capOcorrencias) {
+            size_t nova = t->capOcorrencias ? t->capOcorrencias * 2 : 1024;
+            OcorrenciaTrigrama *o = nova <= UINT32_MAX ?
+                (OcorrenciaTrigrama*) realloc(t->ocorrencias, nova * sizeof(OcorrenciaTrigrama)) : NULL;
+            if (!o) { fprintf(stderr, "Erro: malloc trigramas\n"); exit(EXIT_FAILURE); }
+            t->ocorrencias = o;
+            t->capOcorrencias = nova;
+        }
+        uint32_t pos = (uint32_t)t->totalOcorrencias++;
+        t->ocorrencias[pos].pista = pista;
+        t->ocorrencias[pos].proxima = e->primeira;
+        e->primeira = pos;
+        e->total++;
+    }
+}
+
+void liberarTrigramas(IndiceTrigramas *t) {
+    free(t->entradas);
+    free(t->ocorrencias);
+    t->entradas = NULL;
+    t->ocorrencias = NULL;
+    t->capacidade = t->total = t->totalOcorrencias = t->capOcorrencias = 0;
+}
+
+/* -------------------------
+   Coleção de pistas: AVL + índice de trigramas
+   -------------------------*/
+
+void inicializarColecao(ColecaoPistas *c) {
+    c->raiz = NULL;
+    c->nos = NULL;
+    c->total = c->capacidade = 0;
+    inicializarTrigramas(&c->trigramas);
+}
+
+// Insere na AVL e, se a pista for nova, no índice de trigramas; NULL se já existia
+PistaNode* inserirPistaChave(ColecaoPistas *c, const ChavePista *chave) {
+    PistaNode *n = inserirNaAVL(&c->raiz, chave);
+    if (!n) return NULL;
+    if (c->total == c->capacidade) {
+        int nova = c->capacidade ? c->capacidade * 2 : 64;
+        PistaNode **nos = (PistaNode**) realloc(c->nos, (size_t)nova * sizeof(PistaNode*));
+        if (!nos) { fprintf(stderr, "Erro: malloc pistas\n"); exit(EXIT_FAILURE); }
+        c->nos = nos;
+        c->capacidade = nova;
+    }
+    c->nos[c->total] = n;
+    indexarTrigramas(&c->trigramas, (uint32_t)c->total, n->pista.texto, n->pista.meta.len);
+    c->total++;
+    return n;
+}
+
+PistaNode* inserirPista(ColecaoPistas *c, const char *pista) {
+    if (pista == NULL || pista[0] == '\0') return NULL;
+    ChavePista chave;
+    DEFINIR_CHAVE(chave, pista);
+    return inserirPistaChave(c, &chave);
+}
+
+PistaNode* buscarPista(PistaNode *raiz, const char *pista) {
+    if (!pista) return NULL;
+    MetaChave meta;
+    preencherMetaChave(&meta, pista);
+    while (raiz) {
+        int cmp = compararChaves(&meta, pista, &raiz->pista.meta, raiz->pista.texto);
+        if (cmp == 0) return raiz;
+        raiz = cmp < 0 ? raiz->esquerda : raiz->direita;
+    }
+    return NULL;
+}
+
+/* Percurso em ordem com pilha explícita (a altura da AVL limita o tamanho) */
+void percorrerPistas(PistaNode *raiz, void (*visitar)(PistaNode *no, void *contexto), void *contexto) {
+    PistaNode *pilha[ALTURA_MAX_AVL];
+    int topo = 0;
+    PistaNode *atual = raiz;
+    while (atual || topo > 0) {
+        while (atual) {
+            pilha[topo++] = atual;
+            atual = atual->esquerda;
+        }
+        atual = pilha[--topo];
+        visitar(atual, contexto);
+        atual = atual->direita;
+    }
+}
+
+/* -------------------------
+   Arena de textos
+   -------------------------*/
+
+// Copia 's' (com '\0') para a arena e devolve o deslocamento
+uint32_t guardarTexto(ArenaTexto *a, const char *s, size_t len) {
+    if (a->usado + len + 1 > a->capacidade) {
+        size_t nova = a->capacidade ? a->capacidade : ARENA_CAPACIDADE_INICIAL;
+        while (a->usado + len + 1 > nova) nova *= 2;
+        char *dados = nova <= UINT32_MAX ? (char*) realloc(a->dados, nova) : NULL;
+        if (!dados) { fprintf(stderr, "Erro: arena de textos\n"); exit(EXIT_FAILURE); }
+        a->dados = dados;
+        a->capacidade = nova;
+    }
+    uint32_t desloc = (uint32_t)a->usado;
+    memcpy(a->dados + a->usado, s, len);
+    a->dados[a->usado + len] = '\0';
+    a->usado += len + 1;
+    return desloc;
+}
+
+/* -------------------------
+   Tabela hash (endereçamento aberto, Robin Hood)
+   -------------------------
+   A posição ideal de uma chave é hash & (capacidade-1). Na inserção, quem
+   está mais longe da sua posição ideal fica com a vaga, o que mantém as
+   sondagens curtas e permite parar a busca assim que a entrada encontrada
+   estiver mais perto de casa do que a distância já percorrida.
+   São dois índices sobre a mesma arena: pista -> suspeito e nome -> suspeito.
+   Cada suspeito aparece uma única vez em 'suspeitos', com o total e a lista
+   das pistas já coletadas contra ele. */
+
+void inicializarIndice(IndiceHash *indice) {
+    indice->capacidade = HASH_CAPACIDADE_INICIAL;
+    indice->total = 0;
+    indice->entradas = (EntradaHash*) calloc(indice->capacidade, sizeof(EntradaHash));
+    if (!indice->entradas) { fprintf(stderr, "Erro: malloc hash\n"); exit(EXIT_FAILURE); }
+}
+
+void inicializarHash(TabelaHash *hash) {
+    inicializarIndice(&hash->pistas);
+    inicializarIndice(&hash->nomes);
+    hash->suspeitos = NULL;
+    hash->totalSuspeitos = hash->capacidadeSuspeitos = 0;
+    hash->textos.dados = NULL;
+    hash->textos.usado = hash->textos.capacidade = 0;
+}
+
+// Coloca 'e' no índice (a chave ainda não pode existir)
+void posicionarEntrada(IndiceHash *indice, EntradaHash e) {
+    size_t mascara = indice->capacidade - 1;
+    size_t i = e.meta.hash & mascara;
+    e.distancia = 1;
+    while (1) {
+        EntradaHash *atual = &indice->entradas[i];
+        if (atual->distancia == 0) {
+            *atual = e;
             return;
         }
+        if (atual->distancia < e.distancia) { // atual está mais perto de casa: cede a vaga
+            EntradaHash tmp = *atual;
+            *atual = e;
+            e = tmp;
+        }
+        e.distancia++;
+        i = (i + 1) & mascara;
+    }
+}
+
+void redimensionarIndice(IndiceHash *indice, size_t novaCapacidade) {
+    EntradaHash *antigas = indice->entradas;
+    size_t capAntiga = indice->capacidade;
+    indice->entradas = (EntradaHash*) calloc(novaCapacidade, sizeof(EntradaHash));
+    if (!indice->entradas) { fprintf(stderr, "Erro: malloc hash\n"); exit(EXIT_FAILURE); }
+    indice->capacidade = novaCapacidade;
+    for (size_t i = 0; i < capAntiga; i++)
+        if (antigas[i].distancia != 0) posicionarEntrada(indice, antigas[i]);
+    free(antigas);
+}
+
+// Procura a entrada do texto; NULL se não existir
+EntradaHash* localizarEntrada(IndiceHash *indice, const char *textos, const MetaChave *meta, const char *texto) {
+    size_t mascara = indice->capacidade - 1;
+    size_t i = meta->hash & mascara;
+    for (uint32_t d = 1; ; d++) {
+        EntradaHash *e = &indice->entradas[i];
+        if (e->distancia < d) return NULL; // vazia ou mais perto de casa: a chave não está aqui
+        if (chavesIguais(&e->meta, textos + e->chave, meta, texto)) return e;
+        i = (i + 1) & mascara;
+    }
+}
+
+// Insere um texto novo no índice, guardando-o na arena; devolve o deslocamento
+uint32_t adicionarAoIndice(IndiceHash *indice, ArenaTexto *textos, const MetaChave *meta,
+                       const char *texto, uint32_t valor) {
+    if ((indice->total + 1) * HASH_CARGA_MAX_DEN > indice->capacidade * HASH_CARGA_MAX_NUM)
+        redimensionarIndice(indice, indice->capacidade * 2);
+
+    EntradaHash e;
+    e.meta = *meta;
+    e.chave = guardarTexto(textos, texto, meta->len);
+    e.valor = valor;
+    posicionarEntrada(indice, e);
+    indice->total++;
+    return e.chave;
+}
+
+// Devolve a posição do suspeito, cadastrando-o na primeira vez que aparece
+uint32_t obterSuspeito(TabelaHash *hash, const char *nome) {
+    MetaChave meta;
+    preencherMetaChave(&meta, nome);
+    EntradaHash *e = localizarEntrada(&hash->nomes, hash->textos.dados, &meta, nome);
+    if (e) return e->valor;
+
+    if (hash->totalSuspeitos == hash->capacidadeSuspeitos) {
+        int nova = hash->capacidadeSuspeitos ? hash->capacidadeSuspeitos * 2 : 8;
+        Suspeito *s = (Suspeito*) realloc(hash->suspeitos, (size_t)nova * sizeof(Suspeito));
+        if (!s) { fprintf(stderr, "Erro: malloc suspeitos\n"); exit(EXIT_FAILURE); }
+        hash->suspeitos = s;
+        hash->capacidadeSuspeitos = nova;
     }
-    HashNode *novo = (HashNode*) malloc(sizeof(HashNode));
-    if (!novo) { fprintf(stderr, "Erro: malloc hash\n"); exit(EXIT_FAILURE); }
-    strncpy(novo->chave, pista, MAX_PISTA-1);
-    novo->chave[MAX_PISTA-1] = '\0';
-    strncpy(novo->suspeito, suspeito, MAX_NOME-1);
-    novo->suspeito[MAX_NOME-1] = '\0';
-    novo->next = hash[h];
-    hash[h] = novo;
+    uint32_t id = (uint32_t)hash->totalSuspeitos++;
+    Suspeito *s = &hash->suspeitos[id];
+    s->nome = adicionarAoIndice(&hash->nomes, &hash->textos, &meta, nome, id);
+    s->totalPistas = 0;
+    s->pistas = NULL;
+    return id;
 }
 
-const char* encontrarSuspeito(HashNode *hash[], const char *pista) {
+void inserirNaHash(TabelaHash *hash, const char *pista, const char *suspeito) {
+    if (!pista || pista[0] == '\0') return;
+    uint32_t id = obterSuspeito(hash, suspeito);
+    MetaChave meta;
+    preencherMetaChave(&meta, pista);
+
+    // evita inserir duplicata de chave (rejeita por hash/comprimento antes do texto)
+    EntradaHash *existente = localizarEntrada(&hash->pistas, hash->textos.dados, &meta, pista);
+    if (existente) {
+        // atualiza suspeito (não deve ocorrer em nosso uso, mas deixamos seguro)
+        existente->valor = id;
+        return;
+    }
+    adicionarAoIndice(&hash->pistas, &hash->textos, &meta, pista, id);
+}
+
+Suspeito* suspeitoDaPista(TabelaHash *hash, const MetaChave *meta, const char *pista) {
+    EntradaHash *e = localizarEntrada(&hash->pistas, hash->textos.dados, meta, pista);
+    return e ? &hash->suspeitos[e->valor] : NULL;
+}
+
+const char* encontrarSuspeitoChave(TabelaHash *hash, const MetaChave *meta, const char *pista) {
+    Suspeito *s = suspeitoDaPista(hash, meta, pista);
+    return s ? hash->textos.dados + s->nome : NULL;
+}
+
+const char* encontrarSuspeito(TabelaHash *hash, const char *pista) {
     if (!pista || pista[0] == '\0') return NULL;
-    unsigned long h = hashString(pista);
-    for (HashNode *it = hash[h]; it != NULL; it = it->next) {
-        if (strcmp(it->chave, pista) == 0) return it->suspeito;
+    MetaChave meta;
+    preencherMetaChave(&meta, pista);
+    return encontrarSuspeitoChave(hash, &meta, pista);
+}
+
+/* -------------------------
+   Evidências por suspeito
+   -------------------------*/
+
+/* Chamada uma vez por pista nova na AVL: soma ao contador do suspeito e
+   encadeia o nó na lista dele (sem alocar nada). */
+void registrarPistaColetada(TabelaHash *hash, PistaNode *no) {
+    Suspeito *s = suspeitoDaPista(hash, &no->pista.meta, no->pista.texto);
+    if (!s) return; // pista sem suspeito associado
+    s->totalPistas++;
+    no->proximaDoSuspeito = s->pistas;
+    s->pistas = no;
+}
+
+int contarPistasPorSuspeito(TabelaHash *hash, const char *nomeSuspeito) {
+    MetaChave meta;
+    preencherMetaChave(&meta, nomeSuspeito);
+    EntradaHash *e = localizarEntrada(&hash->nomes, hash->textos.dados, &meta, nomeSuspeito);
+    return e ? hash->suspeitos[e->valor].totalPistas : 0;
+}
+
+/* Ordena os suspeitos pelo total de pistas (decrescente) com uma contagem:
+   totalPistas nunca passa do número de pistas coletadas, então um balde por
+   valor dá a ordem em O(suspeitos + maior total). Empates mantêm a ordem de
+   cadastro. */
+void ordenarSuspeitosPorEvidencia(TabelaHash *hash, int ordem[]) {
+    int n = hash->totalSuspeitos, maior = 0;
+    for (int i = 0; i < n; i++)
+        if (hash->suspeitos[i].totalPistas > maior) maior = hash->suspeitos[i].totalPistas;
+
+    // inicio[v] = primeira posição do balde de quem tem maior - v pistas
+    int *inicio = (int*) calloc((size_t)maior + 2, sizeof(int));
+    if (!inicio) { fprintf(stderr, "Erro: malloc ranking\n"); exit(EXIT_FAILURE); }
+    for (int i = 0; i < n; i++) inicio[maior - hash->suspeitos[i].totalPistas + 1]++;
+    for (int v = 1; v <= maior + 1; v++) inicio[v] += inicio[v - 1];
+    for (int i = 0; i < n; i++) ordem[inicio[maior - hash->suspeitos[i].totalPistas]++] = i;
+    free(inicio);
+}
+
+void exibirRankingSuspeitos(TabelaHash *hash) {
+    int n = hash->totalSuspeitos;
+    if (n == 0) return;
+    int *ordem = (int*) malloc((size_t)n * sizeof(int));
+    if (!ordem) { fprintf(stderr, "Erro: malloc ranking\n"); exit(EXIT_FAILURE); }
+    ordenarSuspeitosPorEvidencia(hash, ordem);
+
+    printf("Suspeitos por quantidade de evidências:\n");
+    for (int k = 0; k < n; k++) {
+        Suspeito *s = &hash->suspeitos[ordem[k]];
+        printf(" %d. %s: %d pista(s)\n", k + 1, hash->textos.dados + s->nome, s->totalPistas);
+        for (PistaNode *p = s->pistas; p; p = p->proximaDoSuspeito)
+            printf("      - %s\n", p->pista.texto);
     }
-    return NULL;
+    free(ordem);
+}
+
+/* Percorre a árvore em ordem e imprime as pistas */
+void imprimirPista(PistaNode *no, void *contexto) {
+    (void)contexto;
+    printf(" - %s\n", no->pista.texto);
+}
+
+void ignorarPista(PistaNode *no, void *contexto) {
+    (void)no;
+    (void)contexto;
 }
 
-/* Percorre a BST em ordem e imprime as pistas */
 void exibirPistas(PistaNode *raiz) {
-    if (!raiz) return;
-    exibirPistas(raiz->esquerda);
-    printf(" - %s\n", raiz->pista);
-    exibirPistas(raiz->direita);
+    percorrerPistas(raiz, imprimirPista, NULL);
 }
 
-/* Conta quantas pistas em 'raiz' (BST) correspondem ao suspeito 'nomeSuspeito'
-   Usa a tabela hash para mapear pista -> suspeito. */
-int contarPistasPorSuspeitoRec(PistaNode *raiz, HashNode *hash[], const char *nomeSuspeito) {
-    if (!raiz) return 0;
-    int count = 0;
-    count += contarPistasPorSuspeitoRec(raiz->esquerda, hash, nomeSuspeito);
-    const char *s = encontrarSuspeito(hash, raiz->pista);
-    if (s != NULL && strcmp(s, nomeSuspeito) == 0) count++;
-    count += contarPistasPorSuspeitoRec(raiz->direita, hash, nomeSuspeito);
-    return count;
+/* -------------------------
+   Busca por prefixo e por trecho
+   -------------------------*/
+
+/* Varredura de intervalo na AVL: desce até a primeira pista >= prefixo
+   guardando o caminho e segue em ordem enquanto as pistas começarem
+   com o prefixo (O(log n + resultados)). */
+int buscarPistasPorPrefixo(PistaNode *raiz, const char *prefixo,
+                           void (*visitar)(PistaNode *no, void *contexto), void *contexto) {
+    PistaNode *pilha[ALTURA_MAX_AVL];
+    int topo = 0, encontradas = 0;
+    size_t len = strlen(prefixo);
+    while (raiz) {
+        if (strcmp(raiz->pista.texto, prefixo) >= 0) {
+            pilha[topo++] = raiz;
+            raiz = raiz->esquerda;
+        } else {
+            raiz = raiz->direita;
+        }
+    }
+    while (topo > 0) {
+        PistaNode *no = pilha[--topo];
+        if (strncmp(no->pista.texto, prefixo, len) != 0) break;
+        visitar(no, contexto);
+        encontradas++;
+        for (PistaNode *p = no->direita; p; p = p->esquerda) pilha[topo++] = p;
+    }
+    return encontradas;
+}
+
+// Resultado da busca: o prefixo copiado ao lado do nó resolve quase todas
+// as comparações da ordenação sem tocar nos nós (espalhados na memória)
+typedef struct {
+    uint64_t prefixo;
+    PistaNode *no;
+} PistaAchada;
+
+int compararPistasAchadas(const void *a, const void *b) {
+    const PistaAchada *x = (const PistaAchada*) a, *y = (const PistaAchada*) b;
+    if (x->prefixo != y->prefixo) return x->prefixo < y->prefixo ? -1 : 1;
+    return COMPARAR_CHAVES(x->no->pista, y->no->pista);
+}
+
+/* Pistas que contêm 'trecho', em ordem alfabética. Com 3 bytes ou mais usa
+   a lista do trigrama mais raro do trecho; trechos menores conferem todas. */
+int buscarPistasPorTrecho(ColecaoPistas *c, const char *trecho,
+                          void (*visitar)(PistaNode *no, void *contexto), void *contexto) {
+    size_t len = strlen(trecho);
+    PistaAchada *achadas = (PistaAchada*) malloc(((size_t)c->total + 1) * sizeof(PistaAchada));
+    if (!achadas) { fprintf(stderr, "Erro: malloc busca\n"); exit(EXIT_FAILURE); }
+    int n = 0;
+
+    if (len < 3) {
+        for (int i = 0; i < c->total; i++)
+            if (strstr(c->nos[i]->pista.texto, trecho)) {
+                achadas[n].prefixo = c->nos[i]->pista.meta.prefixo;
+                achadas[n++].no = c->nos[i];
+            }
+    } else {
+        EntradaTrigrama *menor = NULL;
+        for (size_t i = 0; i + 3 <= len; i++) {
+            EntradaTrigrama *e = localizarTrigrama(&c->trigramas, codigoTrigrama(trecho + i));
+            if (e->codigo == 0) { menor = NULL; break; } // trigrama ausente: nenhuma pista contém o trecho
+            if (!menor || e->total < menor->total) menor = e;
+        }
+        for (uint32_t o = menor ? menor->primeira : UINT32_MAX; o != UINT32_MAX; o = c->trigramas.ocorrencias[o].proxima) {
+            PistaNode *no = c->nos[c->trigramas.ocorrencias[o].pista];
+            if (len == 3 || strstr(no->pista.texto, trecho)) {
+                achadas[n].prefixo = no->pista.meta.prefixo;
+                achadas[n++].no = no;
+            }
+        }
+    }
+
+    qsort(achadas, (size_t)n, sizeof(PistaAchada), compararPistasAchadas);
+    for (int i = 0; i < n; i++) visitar(achadas[i].no, contexto);
+    free(achadas);
+    return n;
+}
+
+/* Consulta do jogador: termina com '*' = prefixo; senão, trecho */
+int buscarPistas(ColecaoPistas *c, const char *consulta,
+                 void (*visitar)(PistaNode *no, void *contexto), void *contexto) {
+    size_t len = strlen(consulta);
+    if (len > 0 && consulta[len - 1] == '*') {
+        char prefixo[MAX_PISTA];
+        if (len > sizeof(prefixo)) len = sizeof(prefixo);
+        memcpy(prefixo, consulta, len - 1);
+        prefixo[len - 1] = '\0';
+        return buscarPistasPorPrefixo(c->raiz, prefixo, visitar, contexto);
+    }
+    return buscarPistasPorTrecho(c, consulta, visitar, contexto);
+}
+
+
+/* -------------------------
+   Árvore radix de pistas (conjunto compacto)
+   -------------------------
+   Alternativa à AVL para guardar o conjunto de pistas. Cada aresta tem um
+   rótulo de tamanho variável que é só (deslocamento, tamanho) dentro da
+   arena da tabela hash: a pista que já é chave da tabela não ganha outra
+   cópia, e prefixos comuns ficam em um só caminho. Os nós (16 bytes) ficam
+   em um vetor e se ligam por índices; os filhos de um nó formam uma lista
+   ordenada pelo primeiro byte, então o percurso em pré-ordem sai em ordem
+   alfabética (mesma ordem de strcmp). */
+
+#define RADIX_FIM 0x80000000u // bit de 'tamanho': uma pista termina neste nó
+
+static inline uint32_t tamanhoRotulo(const NoRadix *n) { return n->tamanho & ~RADIX_FIM; }
+
+void inicializarRadix(ArvoreRadix *a, TabelaHash *hash) {
+    a->capacidade = 64;
+    a->nos = (NoRadix*) malloc(a->capacidade * sizeof(NoRadix));
+    if (!a->nos) { fprintf(stderr, "Erro: malloc radix\n"); exit(EXIT_FAILURE); }
+    a->nos[0].rotulo = a->nos[0].tamanho = a->nos[0].filho = a->nos[0].irmao = 0; // raiz
+    a->total = 1;
+    a->pistas = 0;
+    a->hash = hash;
+}
+
+uint32_t novoNoRadix(ArvoreRadix *a, uint32_t rotulo, uint32_t tamanho) {
+    if (a->total == a->capacidade) {
+        NoRadix *nos = a->capacidade < UINT32_MAX / 2 ?
+            (NoRadix*) realloc(a->nos, (size_t)a->capacidade * 2 * sizeof(NoRadix)) : NULL;
+        if (!nos) { fprintf(stderr, "Erro: malloc radix\n"); exit(EXIT_FAILURE); }
+        a->nos = nos;
+        a->capacidade *= 2;
+    }
+    NoRadix *n = &a->nos[a->total];
+    n->rotulo = rotulo;
+    n->tamanho = tamanho;
+    n->filho = n->irmao = 0;
+    return a->total++;
+}
+
+/* Desce pelo texto; devolve o nó onde ele termina (ou 0 se sair da árvore)
+   e em *consumido quantos bytes do rótulo desse nó foram usados. */
+uint32_t descerRadix(ArvoreRadix *a, const char *texto, size_t len, uint32_t *consumido) {
+    const char *arena = a->hash->textos.dados;
+    uint32_t no = 0;
+    size_t pos = 0;
+    *consumido = 0;
+    while (pos < len) {
+        uint32_t f = a->nos[no].filho;
+        while (f && (unsigned char)arena[a->nos[f].rotulo] < (unsigned char)texto[pos]) f = a->nos[f].irmao;
+        if (!f || arena[a->nos[f].rotulo] != texto[pos]) return 0;
+        uint32_t t = tamanhoRotulo(&a->nos[f]), k = 0;
+        while (k < t && pos + k < len && arena[a->nos[f].rotulo + k] == texto[pos + k]) k++;
+        if (k < t && pos + k < len) return 0; // diverge no meio do rótulo
+        no = f;
+        pos += k;
+        *consumido = k;
+    }
+    return no;
+}
+
+int contemPistaRadix(ArvoreRadix *a, const char *texto) {
+    if (texto[0] == '\0') return 0;
+    uint32_t consumido;
+    uint32_t no = descerRadix(a, texto, strlen(texto), &consumido);
+    return no != 0 && consumido == tamanhoRotulo(&a->nos[no]) && (a->nos[no].tamanho & RADIX_FIM);
+}
+
+// Deslocamento do texto na arena: reaproveita a chave da tabela hash se houver
+uint32_t textoCompartilhado(TabelaHash *hash, const char *texto, size_t len) {
+    MetaChave meta;
+    preencherMetaChave(&meta, texto);
+    EntradaHash *e = localizarEntrada(&hash->pistas, hash->textos.dados, &meta, texto);
+    return e ? e->chave : guardarTexto(&hash->textos, texto, len);
+}
+
+// Insere a pista; 1 se era nova, 0 se já existia (ou é vazia/longa demais)
+int inserirPistaRadix(ArvoreRadix *a, const char *texto) {
+    size_t len = strlen(texto);
+    if (len == 0 || len >= MAX_PISTA || contemPistaRadix(a, texto)) return 0;
+    uint32_t base = textoCompartilhado(a->hash, texto, len);
+    const char *arena = a->hash->textos.dados; // a arena não muda mais nesta inserção
+
+    uint32_t no = 0, pos = 0;
+    while (1) {
+        if (pos == len) {
+            a->nos[no].tamanho |= RADIX_FIM;
+            break;
+        }
+        uint32_t anterior = 0, f = a->nos[no].filho;
+        while (f && (unsigned char)arena[a->nos[f].rotulo] < (unsigned char)texto[pos]) {
+            anterior = f;
+            f = a->nos[f].irmao;
+        }
+        if (!f || arena[a->nos[f].rotulo] != texto[pos]) { // nenhum filho começa com esse byte
+            uint32_t folha = novoNoRadix(a, base + pos, (uint32_t)(len - pos) | RADIX_FIM);
+            a->nos[folha].irmao = f;
+            if (anterior) a->nos[anterior].irmao = folha; else a->nos[no].filho = folha;
+            break;
+        }
+        uint32_t t = tamanhoRotulo(&a->nos[f]), k = 0;
+        while (k < t && pos + k < len && arena[a->nos[f].rotulo + k] == texto[pos + k]) k++;
+        if (k == t) { // rótulo inteiro casou: desce
+            no = f;
+            pos += k;
+            continue;
+        }
+        // divide o rótulo de f: meio (k bytes) -> f (restante)
+        uint32_t meio = novoNoRadix(a, a->nos[f].rotulo, k);
+        a->nos[meio].irmao = a->nos[f].irmao;
+        a->nos[meio].filho = f;
+        if (anterior) a->nos[anterior].irmao = meio; else a->nos[no].filho = meio;
+        a->nos[f].rotulo += k;
+        a->nos[f].tamanho -= k;
+        a->nos[f].irmao = 0;
+        no = meio;
+        pos += k;
+    }
+    a->pistas++;
+    return 1;
+}
+
+/* Visita em ordem alfabética as pistas que começam com 'prefixo' ("" = todas).
+   Pré-ordem com pilha explícita de (nó, tamanho do texto antes do nó). */
+int percorrerRadix(ArvoreRadix *a, const char *prefixo,
+                   void (*visitar)(const char *texto, void *contexto), void *contexto) {
+    const char *arena = a->hash->textos.dados;
+    size_t lenPrefixo = strlen(prefixo);
+    uint32_t consumido;
+    uint32_t inicio = lenPrefixo ? descerRadix(a, prefixo, lenPrefixo, &consumido) : 0;
+    if (lenPrefixo && inicio == 0) return 0;
+
+    char texto[MAX_PISTA];
+    uint32_t antes = (uint32_t)lenPrefixo - (lenPrefixo ? consumido : 0);
+    memcpy(texto, prefixo, antes);
+
+    struct { uint32_t no, antes; } pilha[2 * MAX_PISTA + 2];
+    int topo = 0, visitadas = 0;
+    pilha[topo].no = inicio;
+    pilha[topo++].antes = antes;
+    while (topo > 0) {
+        uint32_t no = pilha[--topo].no, d = pilha[topo].antes;
+        const NoRadix *n = &a->nos[no];
+        uint32_t t = tamanhoRotulo(n);
+        memcpy(texto + d, arena + n->rotulo, t);
+        texto[d + t] = '\0';
+        if (n->tamanho & RADIX_FIM) {
+            visitar(texto, contexto);
+            visitadas++;
+        }
+        if (no != inicio && n->irmao) { // irmãos do nó inicial ficam fora do prefixo
+            pilha[topo].no = n->irmao;
+            pilha[topo++].antes = d;
+        }
+        if (n->filho) {
+            pilha[topo].no = n->filho;
+            pilha[topo++].antes = d + t;
+        }
+    }
+    return visitadas;
+}
+
+size_t memoriaRadix(const ArvoreRadix *a) {
+    return (size_t)a->capacidade * sizeof(NoRadix);
+}
+
+void liberarRadix(ArvoreRadix *a) {
+    free(a->nos);
+    a->nos = NULL;
+    a->total = a->capacidade = a->pistas = 0;
+}
+
+/* Relatório: mesma coleção na AVL e na radix, conferindo que as duas
+   listam as mesmas pistas na mesma ordem. */
+typedef struct {
+    const char **textos;
+    int total, posicao, divergencias;
+} ConferenciaRadix;
+
+void guardarTextoPista(PistaNode *no, void *contexto) {
+    ConferenciaRadix *c = (ConferenciaRadix*) contexto;
+    c->textos[c->total++] = no->pista.texto;
+}
+
+void conferirTextoRadix(const char *texto, void *contexto) {
+    ConferenciaRadix *c = (ConferenciaRadix*) contexto;
+    if (c->posicao >= c->total || strcmp(c->textos[c->posicao], texto) != 0) c->divergencias++;
+    c->posicao++;
+}
+
+void relatorioMemoriaPistas(ColecaoPistas *colecao, TabelaHash *hash) {
+    ArvoreRadix radix;
+    inicializarRadix(&radix, hash);
+    size_t arenaAntes = hash->textos.usado;
+    long long t0 = agoraNs();
+    for (int i = 0; i < colecao->total; i++) inserirPistaRadix(&radix, colecao->nos[i]->pista.texto);
+    long long t1 = agoraNs();
+
+    ConferenciaRadix c = {NULL, 0, 0, 0};
+    c.textos = (const char**) malloc(((size_t)colecao->total + 1) * sizeof(char*));
+    if (!c.textos) { fprintf(stderr, "Erro: malloc relatório\n"); exit(EXIT_FAILURE); }
+    percorrerPistas(colecao->raiz, guardarTextoPista, &c);
+    percorrerRadix(&radix, "", conferirTextoRadix, &c);
+    free(c.textos);
+
+    size_t bytesTexto = 0;
+    for (int i = 0; i < colecao->total; i++) bytesTexto += colecao->nos[i]->pista.meta.len + 1;
+    size_t avl = (size_t)colecao->total * sizeof(PistaNode) + (size_t)colecao->capacidade * sizeof(PistaNode*);
+    size_t trigramas = colecao->trigramas.capacidade * sizeof(EntradaTrigrama) +
+                       colecao->trigramas.capOcorrencias * sizeof(OcorrenciaTrigrama);
+    double n = colecao->total ? (double)colecao->total : 1.0;
+
+    printf("\n--- Memória do conjunto de pistas: %d pista(s), %.1f bytes de texto em média ---\n",
+           colecao->total, bytesTexto / n - 1);
+    printf("%-34s %14s %12s\n", "ESTRUTURA", "BYTES", "POR PISTA");
+    printf("%-34s %14zu %12.1f\n", "AVL (nós com texto fixo)", avl, avl / n);
+    printf("%-34s %14zu %12.1f\n", "índice de trigramas (busca)", trigramas, trigramas / n);
+    printf("%-34s %14zu %12.1f\n", "radix (nós)", memoriaRadix(&radix), memoriaRadix(&radix) / n);
+    printf("%-34s %14zu %12.1f\n", "radix: textos novos na arena", hash->textos.usado - arenaAntes,
+           (hash->textos.usado - arenaAntes) / n);
+    printf("Radix: %u nós, montada em %.3f ms; textos compartilhados com as chaves da tabela hash.\n",
+           radix.total, (t1 - t0) / 1e6);
+    printf("Conferência AVL x radix: %s\n", c.divergencias == 0 && c.posicao == c.total ? "mesmas pistas, mesma ordem" : "DIVERGENTE");
+    liberarRadix(&radix);
 }
 
 /* verificarSuspeitoFinal() – conduz à fase de julgamento final.
-   Solicita ao jogador o nome do suspeito e verifica se existem ao menos 2 pistas
+   Solicita ao jogador o nome do suspeito e verifica se existem ao menos LIMIAR_ACUSACAO pistas
    que apontem para ele. */
-void verificarSuspeitoFinal(PistaNode *pistasColetadas, HashNode *hash[]) {
+void verificarSuspeitoFinal(PistaNode *pistasColetadas, TabelaHash *hash) {
     if (pistasColetadas == NULL) {
         printf("\nNenhuma pista coletada. Não há base para acusação.\n");
         return;
@@ -185,6 +1200,8 @@ void verificarSuspeitoFinal(PistaNode *pistasColetadas, HashNode *hash[]) {
     printf("\n========================================\n");
     printf("Relatório de pistas coletadas (A → Z):\n");
     exibirPistas(pistasColetadas);
+    printf("----------------------------------------\n");
+    exibirRankingSuspeitos(hash);
     printf("========================================\n");
 
     char acusado[MAX_NOME];
@@ -203,9 +1220,9 @@ void verificarSuspeitoFinal(PistaNode *pistasColetadas, HashNode *hash[]) {
         return;
     }
 
-    int total = contarPistasPorSuspeitoRec(pistasColetadas, hash, acusado);
+    int total = contarPistasPorSuspeito(hash, acusado);
     printf("\nO jogo encontrou %d pista(s) que conectam ao suspeito \"%s\".\n", total, acusado);
-    if (total >= 2) {
+    if (total >= LIMIAR_ACUSACAO) {
         printf("Resultado: Acusação SUSTENTADA. \"%s\" é considerado culpado com base nas pistas.\n", acusado);
     } else {
         printf("Resultado: Acusação NÃO SUSTENTADA. Não há pistas suficientes para vincular \"%s\" ao crime.\n", acusado);
@@ -215,21 +1232,28 @@ void verificarSuspeitoFinal(PistaNode *pistasColetadas, HashNode *hash[]) {
 /* explorarSalas() – navega pela árvore e ativa o sistema de pistas.
    Ao visitar uma sala com pista, ela é coletada automaticamente (inserida na BST).
    Para evitar coletar a mesma pista várias vezes, após coletá-la, a pista da sala é
-   zerada (pista coletada apenas uma vez por sala). */
-void explorarSalas(Sala *atual, PistaNode **bstPistas, HashNode *hash[]) {
-    if (!atual) return;
+   zerada (pista coletada apenas uma vez por sala).
+   Cada pista nova também atualiza o contador e a lista do seu suspeito.
+   A opção 'c' mostra o caminho mais curto até uma sala (ou até a sala de
+   uma pista) a partir da sala atual. */
+void explorarSalas(Mansao *mansao, ColecaoPistas *pistas, TabelaHash *hash, IndiceCaminhos *caminhos) {
+    if (mansao->totalSalas == 0) return;
+    Sala *atual = &mansao->salas[0];
     char escolha;
 
     while (1) {
-        printf("\nVocê está em: %s\n", atual->nome);
+        printf("\nVocê está em: %s\n", mansao->textos + atual->nome);
 
-        if (strlen(atual->pista) > 0) {
-            printf("Pista encontrada: \"%s\"\n", atual->pista);
-            // coleciona: inserir na BST (sem duplicatas)
-            *bstPistas = inserirPista(*bstPistas, atual->pista);
+        if (atual->pista != 0) {
+            const char *pista = mansao->textos + atual->pista;
+            printf("Pista encontrada: \"%s\"\n", pista);
+            // coleciona: inserir na AVL (sem duplicatas) e, se for nova,
+            // somar às evidências do suspeito correspondente
+            PistaNode *nova = inserirPista(pistas, pista);
+            if (nova) registrarPistaColetada(hash, nova);
             // marca como coletada para evitar coleta repetida numa futura visita
             // (simplificação de jogo)
-            atual->pista[0] = '\0';
+            atual->pista = 0;
         } else {
             printf("Sem pistas neste cômodo.\n");
         }
@@ -237,6 +1261,8 @@ void explorarSalas(Sala *atual, PistaNode **bstPistas, HashNode *hash[]) {
         printf("Para onde deseja ir?\n");
         printf(" (e) esquerda\n");
         printf(" (d) direita\n");
+        printf(" (c) caminho até uma sala ou pista\n");
+        printf(" (b) buscar nas pistas coletadas\n");
         printf(" (s) sair da exploração\n");
         printf("Escolha: ");
         if (scanf(" %c", &escolha) != 1) {
@@ -248,110 +1274,925 @@ void explorarSalas(Sala *atual, PistaNode **bstPistas, HashNode *hash[]) {
             printf("Exploração encerrada pelo jogador.\n");
             return;
         } else if (escolha == 'e') {
-            if (atual->esquerda != NULL) atual = atual->esquerda;
+            if (atual->esquerda != SEM_SALA) atual = &mansao->salas[atual->esquerda];
             else printf("Não há caminho à esquerda.\n");
         } else if (escolha == 'd') {
-            if (atual->direita != NULL) atual = atual->direita;
+            if (atual->direita != SEM_SALA) atual = &mansao->salas[atual->direita];
             else printf("Não há caminho à direita.\n");
+        } else if (escolha == 'c') {
+            char destino[MAX_PISTA];
+            printf("Nome da sala ou texto da pista: ");
+            getchar(); // remove o '\n' da escolha
+            if (!fgets(destino, sizeof(destino), stdin)) continue;
+            destino[strcspn(destino, "\r\n")] = '\0';
+            int32_t alvo = localizarSala(caminhos, destino);
+            if (alvo == SEM_SALA) printf("Nenhuma sala ou pista com esse nome.\n");
+            else exibirCaminho(caminhos, (int32_t)(atual - mansao->salas), alvo);
+        } else if (escolha == 'b') {
+            char consulta[MAX_PISTA];
+            printf("Trecho da pista (termine com '*' para buscar pelo começo): ");
+            getchar(); // remove o '\n' da escolha
+            if (!fgets(consulta, sizeof(consulta), stdin)) continue;
+            consulta[strcspn(consulta, "\r\n")] = '\0';
+            if (buscarPistas(pistas, consulta, imprimirPista, NULL) == 0) printf("Nenhuma pista coletada corresponde.\n");
         } else {
-            printf("Opção inválida. Use 'e', 'd' ou 's'.\n");
+            printf("Opção inválida. Use 'e', 'd', 'c', 'b' ou 's'.\n");
         }
     }
 }
 
+/* -------------------------
+   Caminhos entre salas (LCA)
+   -------------------------
+   Um percurso iterativo a partir da entrada preenche pai e profundidade
+   de cada sala e o percurso de Euler (a sala é anotada ao entrar e ao
+   voltar de cada filho: 2n-1 posições). O ancestral comum mais baixo de
+   a e b é a sala mais rasa entre as primeiras ocorrências de a e b no
+   percurso. O percurso é cortado em blocos de BLOCO_LCA posições:
+   - dentro do bloco, cada posição guarda em uma máscara de 32 bits a
+     pilha de mínimos do início do bloco até ela; o mínimo de [l, r] é o
+     bit mais baixo de mascaras[r] a partir de l (um ctz);
+   - entre blocos, uma tabela esparsa guarda só o mínimo de cada bloco,
+     para grupos de 2^k blocos.
+   Cada consulta continua O(1) e a memória fica em O(n) (a tabela tem
+   n/16 * log n entradas em vez de 2n * log n).
+   Distância = prof[a] + prof[b] - 2*prof[lca]; o caminho sobe de a até o
+   lca e desce até b pelos pais (O(tamanho do caminho)).
+   Nomes de salas e pistas são indexados no próprio bloco de textos da
+   mansão, sem cópias. */
+
+// Sala mais rasa entre duas candidatas
+static inline int32_t maisRasa(const IndiceCaminhos *c, int32_t a, int32_t b) {
+    return c->profundidade[a] <= c->profundidade[b] ? a : b;
+}
+
+static inline int log2Inteiro(int x) {
+    return 31 - __builtin_clz((unsigned)x);
+}
+
+// Indexa um texto do bloco da mansão (a primeira sala com cada texto vence)
+void indexarTextoSala(IndiceHash *indice, const char *textos, uint32_t desloc, int32_t sala) {
+    EntradaHash e;
+    preencherMetaChave(&e.meta, textos + desloc);
+    if (localizarEntrada(indice, textos, &e.meta, textos + desloc)) return;
+    if ((indice->total + 1) * HASH_CARGA_MAX_DEN > indice->capacidade * HASH_CARGA_MAX_NUM)
+        redimensionarIndice(indice, indice->capacidade * 2);
+    e.chave = desloc;
+    e.valor = (uint32_t)sala;
+    posicionarEntrada(indice, e);
+    indice->total++;
+}
+
+int32_t* alocarInt32(size_t n) {
+    int32_t *v = (int32_t*) malloc((n ? n : 1) * sizeof(int32_t));
+    if (!v) { fprintf(stderr, "Erro: malloc caminhos\n"); exit(EXIT_FAILURE); }
+    return v;
+}
+
+void construirIndiceCaminhos(IndiceCaminhos *c, Mansao *m) {
+    int n = m->totalSalas;
+    c->mansao = m;
+    c->pai = alocarInt32((size_t)n);
+    c->profundidade = alocarInt32((size_t)n);
+    c->primeira = alocarInt32((size_t)n);
+    c->euler = alocarInt32(2 * (size_t)n);
+    for (int i = 0; i < n; i++) {
+        c->pai[i] = SEM_SALA;
+        c->profundidade[i] = -1; // inalcançável até o percurso chegar nela
+    }
+
+    // percurso de Euler com pilha explícita (sala, próximo filho a visitar)
+    int32_t *pilhaSala = alocarInt32((size_t)n);
+    unsigned char *pilhaEstado = (unsigned char*) malloc((size_t)n + 1);
+    if (!pilhaEstado) { fprintf(stderr, "Erro: malloc caminhos\n"); exit(EXIT_FAILURE); }
+    int topo = 0, len = 0;
+    pilhaSala[topo] = 0;
+    pilhaEstado[topo++] = 0;
+    c->profundidade[0] = 0;
+    c->primeira[0] = len;
+    c->euler[len++] = 0;
+    while (topo > 0) {
+        int32_t v = pilhaSala[topo - 1];
+        int estado = pilhaEstado[topo - 1]++;
+        if (estado == 2) { // os dois filhos já foram: volta ao pai
+            topo--;
+            if (topo > 0) c->euler[len++] = pilhaSala[topo - 1];
+            continue;
+        }
+        int32_t filho = estado == 0 ? m->salas[v].esquerda : m->salas[v].direita;
+        if (filho == SEM_SALA || c->profundidade[filho] >= 0) continue; // sem caminho ou já ligada a outro pai
+        c->pai[filho] = v;
+        c->profundidade[filho] = c->profundidade[v] + 1;
+        c->primeira[filho] = len;
+        c->euler[len++] = filho;
+        pilhaSala[topo] = filho;
+        pilhaEstado[topo++] = 0;
+    }
+    free(pilhaSala);
+    free(pilhaEstado);
+    c->tamanhoEuler = len;
+
+    // máscaras dentro de cada bloco e mínimo de cada bloco (nível 0 da tabela)
+    c->totalBlocos = (len + BLOCO_LCA - 1) / BLOCO_LCA;
+    c->niveis = log2Inteiro(c->totalBlocos) + 1;
+    c->mascaras = (uint32_t*) malloc((size_t)len * sizeof(uint32_t));
+    if (!c->mascaras) { fprintf(stderr, "Erro: malloc caminhos\n"); exit(EXIT_FAILURE); }
+    c->tabela = alocarInt32((size_t)c->niveis * (size_t)c->totalBlocos);
+    for (int b = 0; b < c->totalBlocos; b++) {
+        int inicio = b * BLOCO_LCA;
+        uint32_t pilha = 0; // bit j = posição inicio+j ainda é mínimo de um sufixo
+        for (int i = inicio; i < len && i < inicio + BLOCO_LCA; i++) {
+            int32_t prof = c->profundidade[c->euler[i]];
+            while (pilha) { // desempilha os mais fundos que a posição nova
+                int j = 31 - __builtin_clz(pilha);
+                if (c->profundidade[c->euler[inicio + j]] <= prof) break;
+                pilha &= ~(1u << j);
+            }
+            pilha |= 1u << (i - inicio);
+            c->mascaras[i] = pilha;
+        }
+        c->tabela[b] = c->euler[inicio + __builtin_ctz(pilha)];
+    }
+    // tabela esparsa: nível k guarda a sala mais rasa dos blocos b .. b+2^k-1
+    for (int k = 1; k < c->niveis; k++) {
+        int32_t *ant = c->tabela + (size_t)(k - 1) * c->totalBlocos;
+        int32_t *atual = c->tabela + (size_t)k * c->totalBlocos;
+        int meio = 1 << (k - 1);
+        for (int b = 0; b + (1 << k) <= c->totalBlocos; b++)
+            atual[b] = maisRasa(c, ant[b], ant[b + meio]);
+    }
+
+    inicializarIndice(&c->nomes);
+    inicializarIndice(&c->pistas);
+    for (int i = 0; i < n; i++) {
+        indexarTextoSala(&c->nomes, m->textos, m->salas[i].nome, i);
+        if (m->salas[i].pista != 0) indexarTextoSala(&c->pistas, m->textos, m->salas[i].pista, i);
+    }
+}
+
+// Sala com esse nome ou, se não houver, a sala que guarda essa pista
+int32_t localizarSala(IndiceCaminhos *c, const char *texto) {
+    MetaChave meta;
+    preencherMetaChave(&meta, texto);
+    EntradaHash *e = localizarEntrada(&c->nomes, c->mansao->textos, &meta, texto);
+    if (!e) e = localizarEntrada(&c->pistas, c->mansao->textos, &meta, texto);
+    return e ? (int32_t)e->valor : SEM_SALA;
+}
+
+// Sala mais rasa de euler[l .. r], com l e r no mesmo bloco
+static inline int32_t minimoNoBloco(const IndiceCaminhos *c, int l, int r) {
+    uint32_t m = c->mascaras[r] & (~0u << (l % BLOCO_LCA));
+    return c->euler[l - l % BLOCO_LCA + __builtin_ctz(m)];
+}
+
+int32_t ancestralComum(const IndiceCaminhos *c, int32_t a, int32_t b) {
+    if (c->profundidade[a] < 0 || c->profundidade[b] < 0) return SEM_SALA;
+    int l = c->primeira[a], r = c->primeira[b];
+    if (l > r) { int t = l; l = r; r = t; }
+    int bl = l / BLOCO_LCA, br = r / BLOCO_LCA;
+    if (bl == br) return minimoNoBloco(c, l, r);
+    int32_t lca = maisRasa(c, minimoNoBloco(c, l, bl * BLOCO_LCA + BLOCO_LCA - 1),
+                           minimoNoBloco(c, br * BLOCO_LCA, r));
+    if (br - bl > 1) { // blocos inteiros entre os dois
+        int k = log2Inteiro(br - bl - 1);
+        const int32_t *nivel = c->tabela + (size_t)k * c->totalBlocos;
+        lca = maisRasa(c, lca, maisRasa(c, nivel[bl + 1], nivel[br - (1 << k)]));
+    }
+    return lca;
+}
+
+// Movimentos entre duas salas (-1 se alguma não for alcançável)
+int distanciaSalas(const IndiceCaminhos *c, int32_t a, int32_t b) {
+    int32_t lca = ancestralComum(c, a, b);
+    if (lca == SEM_SALA) return -1;
+    return c->profundidade[a] + c->profundidade[b] - 2 * c->profundidade[lca];
+}
+
+/* Preenche 'caminho' com as salas de a até b (inclusive) e devolve quantas
+   são; 'caminho' precisa de distanciaSalas(a, b) + 1 posições. */
+int caminhoSalas(const IndiceCaminhos *c, int32_t a, int32_t b, int32_t caminho[]) {
+    int32_t lca = ancestralComum(c, a, b);
+    if (lca == SEM_SALA) return 0;
+    int n = 0;
+    for (int32_t v = a; v != lca; v = c->pai[v]) caminho[n++] = v;
+    caminho[n++] = lca;
+    int fim = n + c->profundidade[b] - c->profundidade[lca];
+    for (int32_t v = b, i = fim - 1; v != lca; v = c->pai[v], i--) caminho[i] = v;
+    return fim;
+}
+
+void exibirCaminho(IndiceCaminhos *c, int32_t a, int32_t b) {
+    int d = distanciaSalas(c, a, b);
+    if (d < 0) {
+        printf("Não há caminho entre essas salas.\n");
+        return;
+    }
+    int32_t *caminho = alocarInt32((size_t)d + 1);
+    int n = caminhoSalas(c, a, b, caminho);
+    printf("%d movimento(s):", d);
+    for (int i = 0; i < n; i++)
+        printf("%s %s", i ? " ->" : "", c->mansao->textos + c->mansao->salas[caminho[i]].nome);
+    printf("\n");
+    free(caminho);
+}
+
+void liberarIndiceCaminhos(IndiceCaminhos *c) {
+    free(c->pai);
+    free(c->profundidade);
+    free(c->primeira);
+    free(c->euler);
+    free(c->mascaras);
+    free(c->tabela);
+    liberarIndice(&c->nomes);
+    liberarIndice(&c->pistas);
+}
+
+/* -------------------------
+   Solucionador automático
+   -------------------------
+   Percorre todas as salas alcançáveis a partir da entrada, sem recursão
+   (pilha explícita que cresce conforme a profundidade), coleta todas as
+   pistas e avalia cada suspeito pelo mesmo critério da acusação
+   (LIMIAR_ACUSACAO pistas). Não altera a mansão. */
+
+typedef struct {
+    int salasVisitadas;
+    int pistasColetadas;
+    int pilhaMaxima;       // maior número de salas pendentes na pilha
+    long long ns;
+} ResultadoSolucao;
+
+ResultadoSolucao resolverMansao(Mansao *mansao, ColecaoPistas *pistas, TabelaHash *hash) {
+    ResultadoSolucao r = {0, 0, 0, 0};
+    if (mansao->totalSalas == 0) return r;
+    long long t0 = agoraNs();
+
+    int capacidade = 64, topo = 0;
+    int32_t *pilha = (int32_t*) malloc((size_t)capacidade * sizeof(int32_t));
+    if (!pilha) { fprintf(stderr, "Erro: malloc pilha\n"); exit(EXIT_FAILURE); }
+    pilha[topo++] = 0;
+
+    while (topo > 0) {
+        Sala *s = &mansao->salas[pilha[--topo]];
+        r.salasVisitadas++;
+
+        if (s->pista != 0) {
+            PistaNode *nova = inserirPista(pistas, mansao->textos + s->pista);
+            if (nova) {
+                registrarPistaColetada(hash, nova);
+                r.pistasColetadas++;
+            }
+        }
+
+        if (topo + 2 > capacidade) {
+            capacidade *= 2;
+            int32_t *nova = (int32_t*) realloc(pilha, (size_t)capacidade * sizeof(int32_t));
+            if (!nova) { fprintf(stderr, "Erro: malloc pilha\n"); exit(EXIT_FAILURE); }
+            pilha = nova;
+        }
+        // direita antes da esquerda: a esquerda é visitada primeiro (pré-ordem)
+        if (s->direita != SEM_SALA) pilha[topo++] = s->direita;
+        if (s->esquerda != SEM_SALA) pilha[topo++] = s->esquerda;
+        if (topo > r.pilhaMaxima) r.pilhaMaxima = topo;
+    }
+    free(pilha);
+    r.ns = agoraNs() - t0;
+    return r;
+}
+
+void exibirResultadoSolucao(const ResultadoSolucao *r, Mansao *mansao, TabelaHash *hash) {
+    printf("\n--- Solução automática ---\n");
+    printf("Salas visitadas: %d de %d | pistas coletadas: %d | pilha máxima: %d | %.3f ms\n",
+           r->salasVisitadas, mansao->totalSalas, r->pistasColetadas, r->pilhaMaxima, r->ns / 1e6);
+
+    int n = hash->totalSuspeitos, sustentadas = 0;
+    int *ordem = (int*) malloc((size_t)(n > 0 ? n : 1) * sizeof(int));
+    if (!ordem) { fprintf(stderr, "Erro: malloc ranking\n"); exit(EXIT_FAILURE); }
+    ordenarSuspeitosPorEvidencia(hash, ordem);
+    printf("%-24s %8s  %s\n", "SUSPEITO", "PISTAS", "ACUSAÇÃO");
+    for (int k = 0; k < n; k++) {
+        Suspeito *s = &hash->suspeitos[ordem[k]];
+        int sustentada = s->totalPistas >= LIMIAR_ACUSACAO;
+        sustentadas += sustentada;
+        printf("%-24s %8d  %s\n", hash->textos.dados + s->nome, s->totalPistas,
+               sustentada ? "sustentada" : "não sustentada");
+    }
+    printf("%d de %d suspeito(s) atingem o limiar de %d pista(s).\n", sustentadas, n, LIMIAR_ACUSACAO);
+    free(ordem);
+}
+
+/* -------------------------
+   Solucionador paralelo (roubo de trabalho)
+   -------------------------
+   Cada thread percorre salas a partir de uma pilha própria, sem travas.
+   Quando a pilha passa de 2*LOTE_ROUBO salas e há threads ociosas, as
+   LOTE_ROUBO salas mais antigas (mais perto da raiz, logo as maiores
+   subárvores) vão para a área compartilhada da thread, de onde as ociosas
+   roubam. As salas com pista vão para um buffer próprio de cada thread,
+   ordenado ao final pelo índice da sala; a junção intercala os buffers e
+   só então insere na AVL e nos contadores, sempre na ordem crescente dos
+   índices, qualquer que seja o número de threads. */
+
+#define MAX_THREADS 64
+#define LOTE_ROUBO 32
+
+typedef struct trabalhoParalelo TrabalhoParalelo;
+
+typedef struct {
+    pthread_mutex_t trava;
+    int32_t *compartilhadas;          // salas disponíveis para roubo
+    atomic_int totalCompartilhadas;   // lido sem trava para evitar vítimas vazias
+    int capCompartilhadas;
+    int32_t *pilha;                   // salas pendentes desta thread
+    int topo, capPilha;
+    int32_t *pistas;                  // salas com pista visitadas por esta thread
+    int totalPistas, capPistas;
+    int salasVisitadas, pilhaMaxima;
+    int id;
+    TrabalhoParalelo *comum;
+} Trabalhador;
+
+struct trabalhoParalelo {
+    Mansao *mansao;
+    Trabalhador *trabalhadores;
+    int totalThreads;
+    atomic_int ociosos;
+};
+
+// Garante espaço para 'n' int32 em *v (capacidade dobra)
+void reservarInt32(int32_t **v, int *capacidade, int n) {
+    if (n <= *capacidade) return;
+    int nova = *capacidade ? *capacidade : 64;
+    while (nova < n) nova *= 2;
+    int32_t *p = (int32_t*) realloc(*v, (size_t)nova * sizeof(int32_t));
+    if (!p) { fprintf(stderr, "Erro: malloc solucionador\n"); exit(EXIT_FAILURE); }
+    *v = p;
+    *capacidade = nova;
+}
+
+// Move as salas da área compartilhada de 'v' para a pilha de 't'
+int pegarCompartilhadas(Trabalhador *t, Trabalhador *v) {
+    if (atomic_load_explicit(&v->totalCompartilhadas, memory_order_relaxed) == 0) return 0;
+    pthread_mutex_lock(&v->trava);
+    int n = atomic_load_explicit(&v->totalCompartilhadas, memory_order_relaxed);
+    if (n > 0) {
+        reservarInt32(&t->pilha, &t->capPilha, t->topo + n);
+        memcpy(t->pilha + t->topo, v->compartilhadas, (size_t)n * sizeof(int32_t));
+        t->topo += n;
+        atomic_store_explicit(&v->totalCompartilhadas, 0, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&v->trava);
+    return n;
+}
+
+// Oferece as salas mais antigas da pilha se alguém estiver sem trabalho
+void oferecerTrabalho(Trabalhador *t) {
+    if (t->topo < 2 * LOTE_ROUBO ||
+        atomic_load_explicit(&t->comum->ociosos, memory_order_relaxed) == 0 ||
+        atomic_load_explicit(&t->totalCompartilhadas, memory_order_relaxed) != 0) return;
+    pthread_mutex_lock(&t->trava);
+    reservarInt32(&t->compartilhadas, &t->capCompartilhadas, LOTE_ROUBO);
+    memcpy(t->compartilhadas, t->pilha, LOTE_ROUBO * sizeof(int32_t));
+    atomic_store_explicit(&t->totalCompartilhadas, LOTE_ROUBO, memory_order_relaxed);
+    pthread_mutex_unlock(&t->trava);
+    t->topo -= LOTE_ROUBO;
+    memmove(t->pilha, t->pilha + LOTE_ROUBO, (size_t)t->topo * sizeof(int32_t));
+}
+
+// Sem trabalho local: recupera o próprio compartilhado ou rouba de outra thread
+int buscarTrabalho(Trabalhador *t) {
+    TrabalhoParalelo *c = t->comum;
+    if (pegarCompartilhadas(t, t)) return 1;
+    atomic_fetch_add(&c->ociosos, 1);
+    while (1) {
+        for (int k = 1; k < c->totalThreads; k++) {
+            if (pegarCompartilhadas(t, &c->trabalhadores[(t->id + k) % c->totalThreads])) {
+                atomic_fetch_sub(&c->ociosos, 1);
+                return 1;
+            }
+        }
+        // todas ociosas: as áreas compartilhadas estão vazias e ninguém vai oferecer mais
+        if (atomic_load(&c->ociosos) == c->totalThreads) return 0;
+        sched_yield();
+    }
+}
+
+int compararInt32(const void *a, const void *b) {
+    int32_t x = *(const int32_t*)a, y = *(const int32_t*)b;
+    return (x > y) - (x < y);
+}
+
+void* percorrerTrabalhador(void *arg) {
+    Trabalhador *t = (Trabalhador*) arg;
+    Sala *salas = t->comum->mansao->salas;
+    while (t->topo > 0 || buscarTrabalho(t)) {
+        int32_t i = t->pilha[--t->topo];
+        Sala *s = &salas[i];
+        t->salasVisitadas++;
+        if (s->pista != 0) {
+            reservarInt32(&t->pistas, &t->capPistas, t->totalPistas + 1);
+            t->pistas[t->totalPistas++] = i;
+        }
+        reservarInt32(&t->pilha, &t->capPilha, t->topo + 2);
+        if (s->direita != SEM_SALA) t->pilha[t->topo++] = s->direita;
+        if (s->esquerda != SEM_SALA) t->pilha[t->topo++] = s->esquerda;
+        if (t->topo > t->pilhaMaxima) t->pilhaMaxima = t->topo;
+        oferecerTrabalho(t);
+    }
+    qsort(t->pistas, (size_t)t->totalPistas, sizeof(int32_t), compararInt32);
+    return NULL;
+}
+
+ResultadoSolucao resolverMansaoParalelo(Mansao *mansao, ColecaoPistas *pistas, TabelaHash *hash, int totalThreads) {
+    ResultadoSolucao r = {0, 0, 0, 0};
+    if (mansao->totalSalas == 0) return r;
+    if (totalThreads < 1) totalThreads = 1;
+    if (totalThreads > MAX_THREADS) totalThreads = MAX_THREADS;
+    long long t0 = agoraNs();
+
+    TrabalhoParalelo comum;
+    Trabalhador *ts = (Trabalhador*) calloc((size_t)totalThreads, sizeof(Trabalhador));
+    if (!ts) { fprintf(stderr, "Erro: malloc solucionador\n"); exit(EXIT_FAILURE); }
+    comum.mansao = mansao;
+    comum.trabalhadores = ts;
+    comum.totalThreads = totalThreads;
+    atomic_init(&comum.ociosos, 0);
+    for (int i = 0; i < totalThreads; i++) {
+        pthread_mutex_init(&ts[i].trava, NULL);
+        atomic_init(&ts[i].totalCompartilhadas, 0);
+        ts[i].id = i;
+        ts[i].comum = &comum;
+    }
+    reservarInt32(&ts[0].pilha, &ts[0].capPilha, 1);
+    ts[0].pilha[ts[0].topo++] = 0; // a entrada começa na thread 0; as demais roubam
+
+    pthread_t threads[MAX_THREADS];
+    for (int i = 1; i < totalThreads; i++) {
+        if (pthread_create(&threads[i], NULL, percorrerTrabalhador, &ts[i]) != 0) {
+            fprintf(stderr, "Erro: pthread_create\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    percorrerTrabalhador(&ts[0]);
+    for (int i = 1; i < totalThreads; i++) pthread_join(threads[i], NULL);
+
+    // junção determinística: intercala os buffers ordenados pelo índice da sala
+    int *pos = (int*) calloc((size_t)totalThreads, sizeof(int));
+    if (!pos) { fprintf(stderr, "Erro: malloc solucionador\n"); exit(EXIT_FAILURE); }
+    while (1) {
+        int melhor = -1;
+        for (int i = 0; i < totalThreads; i++)
+            if (pos[i] < ts[i].totalPistas &&
+                (melhor < 0 || ts[i].pistas[pos[i]] < ts[melhor].pistas[pos[melhor]])) melhor = i;
+        if (melhor < 0) break;
+        Sala *s = &mansao->salas[ts[melhor].pistas[pos[melhor]++]];
+        PistaNode *nova = inserirPista(pistas, mansao->textos + s->pista);
+        if (nova) {
+            registrarPistaColetada(hash, nova);
+            r.pistasColetadas++;
+        }
+    }
+    free(pos);
+
+    for (int i = 0; i < totalThreads; i++) {
+        r.salasVisitadas += ts[i].salasVisitadas;
+        if (ts[i].pilhaMaxima > r.pilhaMaxima) r.pilhaMaxima = ts[i].pilhaMaxima;
+        pthread_mutex_destroy(&ts[i].trava);
+        free(ts[i].compartilhadas);
+        free(ts[i].pilha);
+        free(ts[i].pistas);
+    }
+    free(ts);
+    r.ns = agoraNs() - t0;
+    return r;
+}
+
+/* -------------------------
+   Gerador de mansões (para testar o carregador e o solucionador)
+   -------------------------
+   Formas: "aleatoria" (cada sala nova ocupa um caminho livre sorteado entre
+   as anteriores), "balanceada" (filhos de i em 2i+1 e 2i+2) e "corredor"
+   (só caminhos à esquerda: profundidade = número de salas). Metade das
+   salas tem pista, distribuídas entre GERADOR_SUSPEITOS suspeitos. */
+
+#define GERADOR_SUSPEITOS 16
+
+uint64_t proximoAleatorio(uint64_t *estado) { // splitmix64
+    uint64_t z = (*estado += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+int gerarMansao(const char *caminho, int totalSalas, const char *forma) {
+    int modo = strcmp(forma, "aleatoria") == 0 ? 0 : strcmp(forma, "balanceada") == 0 ? 1 :
+               strcmp(forma, "corredor") == 0 ? 2 : -1;
+    if (modo < 0 || totalSalas < 1) {
+        printf("Forma inválida (use aleatoria, balanceada ou corredor) ou número de salas < 1.\n");
+        return 0;
+    }
+
+    int32_t *filhos = (int32_t*) malloc((size_t)totalSalas * 2 * sizeof(int32_t));
+    if (!filhos) { fprintf(stderr, "Erro: malloc gerador\n"); exit(EXIT_FAILURE); }
+    for (long i = 0; i < (long)totalSalas * 2; i++) filhos[i] = SEM_SALA;
+
+    uint64_t estado = 42;
+    if (modo == 0) {
+        // caminhos livres (sala*2 + lado); sorteia um e troca com o último
+        int32_t *livres = (int32_t*) malloc(((size_t)totalSalas + 1) * sizeof(int32_t));
+        if (!livres) { fprintf(stderr, "Erro: malloc gerador\n"); exit(EXIT_FAILURE); }
+        int nLivres = 0;
+        livres[nLivres++] = 0;
+        livres[nLivres++] = 1;
+        for (int32_t j = 1; j < totalSalas; j++) {
+            int k = (int)(proximoAleatorio(&estado) % (uint64_t)nLivres);
+            filhos[livres[k]] = j;
+            livres[k] = livres[--nLivres];
+            livres[nLivres++] = j * 2;
+            livres[nLivres++] = j * 2 + 1;
+        }
+        free(livres);
+    } else {
+        for (long i = 0; i < totalSalas; i++) {
+            long e = modo == 1 ? 2 * i + 1 : i + 1, d = 2 * i + 2;
+            if (e < totalSalas) filhos[2 * i] = (int32_t)e;
+            if (modo == 1 && d < totalSalas) filhos[2 * i + 1] = (int32_t)d;
+        }
+    }
+
+    EscritorCSV escritor;
+    if (!abrirEscritorCSV(&escritor, caminho)) {
+        printf("Não foi possível criar o arquivo \"%s\".\n", caminho);
+        free(filhos);
+        return 0;
+    }
+    char texto[MAX_PISTA];
+    for (int i = 0; i < totalSalas; i++) {
+        escreverTextoCSV(&escritor, "sala", ',');
+        snprintf(texto, sizeof(texto), "Sala %d", i);
+        escreverTextoCSV(&escritor, texto, ',');
+        if (i % 2 == 0) {
+            snprintf(texto, sizeof(texto), "Pista %d", i);
+            escreverTextoCSV(&escritor, texto, ',');
+        } else {
+            escreverTextoCSV(&escritor, "", ',');
+        }
+        escreverInteiroCSV(&escritor, filhos[2 * i], ',');
+        escreverInteiroCSV(&escritor, filhos[2 * i + 1], '\n');
+    }
+    for (int i = 0; i < totalSalas; i += 2) {
+        escreverTextoCSV(&escritor, "suspeito", ',');
+        snprintf(texto, sizeof(texto), "Pista %d", i);
+        escreverTextoCSV(&escritor, texto, ',');
+        snprintf(texto, sizeof(texto), "Suspeito %02d", (int)(proximoAleatorio(&estado) % GERADOR_SUSPEITOS));
+        escreverTextoCSV(&escritor, texto, '\n');
+    }
+    free(filhos);
+    if (!fecharEscritorCSV(&escritor)) {
+        printf("Erro ao gravar \"%s\".\n", caminho);
+        return 0;
+    }
+    return 1;
+}
+
 /* utilitárias de limpeza de memória */
+/* Libera a árvore sem recursão: gira à direita até não haver filho à
+   esquerda, libera a raiz e segue pela direita (O(n), memória O(1)) */
 void liberarBST(PistaNode *raiz) {
-    if (!raiz) return;
-    liberarBST(raiz->esquerda);
-    liberarBST(raiz->direita);
-    free(raiz);
+    while (raiz) {
+        if (raiz->esquerda) {
+            PistaNode *e = raiz->esquerda;
+            raiz->esquerda = e->direita;
+            e->direita = raiz;
+            raiz = e;
+        } else {
+            PistaNode *prox = raiz->direita;
+            free(raiz);
+            raiz = prox;
+        }
+    }
+}
+
+void liberarColecao(ColecaoPistas *c) {
+    liberarBST(c->raiz);
+    free(c->nos);
+    liberarTrigramas(&c->trigramas);
+    c->raiz = NULL;
+    c->nos = NULL;
+    c->total = c->capacidade = 0;
+}
+
+void liberarIndice(IndiceHash *indice) {
+    free(indice->entradas);
+    indice->entradas = NULL;
+    indice->capacidade = indice->total = 0;
 }
 
-void liberarHash(HashNode *hash[]) {
-    for (int i = 0; i < HASH_SIZE; ++i) {
-        HashNode *it = hash[i];
-        while (it) {
-            HashNode *prox = it->next;
-            free(it);
-            it = prox;
+/* As listas dos suspeitos apontam para nós da AVL: liberar a tabela junto
+   com (ou depois de) liberarBST. */
+void liberarHash(TabelaHash *hash) {
+    liberarIndice(&hash->pistas);
+    liberarIndice(&hash->nomes);
+    free(hash->suspeitos);
+    free(hash->textos.dados);
+    hash->suspeitos = NULL;
+    hash->textos.dados = NULL;
+    hash->totalSuspeitos = hash->capacidadeSuspeitos = 0;
+    hash->textos.usado = hash->textos.capacidade = 0;
+}
+
+/* -------------------------
+   Benchmark de hash: djb2 x hash com semente
+   -------------------------*/
+
+long long agoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* djb2: hash usado originalmente pela tabela encadeada (mantido só como referência) */
+unsigned long hashDjb2(const char *str) {
+    unsigned long hash = 5381;
+    int c;
+    while ((c = (unsigned char)*str++))
+        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+    return hash;
+}
+
+/* Carrega uma pista por linha de 'arquivo'; sem arquivo, gera variações das
+   pistas do jogo (frases parecidas, o pior caso para o djb2). */
+char** carregarPistasBenchmark(const char *arquivo, int *total) {
+    const char *base[] = {
+        "Pegadas enluvadas no carpete", "Perfume caro com resíduo de pó",
+        "Faca faltando no jogo de talheres", "Página arrancada de um testamento",
+        "Terra fresca com impressão de sapato pequeno", "Rótulo de veneno rasgado",
+        "Toalha com manchas de óleo", "Peça de roupa com bordado inicial 'M.'",
+    };
+    int capacidade = 1024, n = 0;
+    char **pistas = (char**) malloc((size_t)capacidade * sizeof(char*));
+    char linha[MAX_PISTA];
+    FILE *f = arquivo ? fopen(arquivo, "r") : NULL;
+    if (arquivo && !f) printf("Não foi possível abrir \"%s\"; usando pistas geradas.\n", arquivo);
+
+    for (int i = 0; pistas; i++) {
+        if (f) {
+            if (!fgets(linha, sizeof(linha), f)) break;
+            linha[strcspn(linha, "\r\n")] = '\0';
+            if (linha[0] == '\0') continue;
+        } else {
+            if (i >= 200000) break;
+            snprintf(linha, sizeof(linha), "%s no cômodo %d", base[i % 8], i / 8);
+        }
+        if (n == capacidade) {
+            capacidade *= 2;
+            char **novo = (char**) realloc(pistas, (size_t)capacidade * sizeof(char*));
+            if (!novo) break;
+            pistas = novo;
         }
-        hash[i] = NULL;
+        pistas[n] = (char*) malloc(strlen(linha) + 1);
+        if (!pistas[n]) break;
+        strcpy(pistas[n++], linha);
+    }
+    if (f) fclose(f);
+    if (!pistas) { fprintf(stderr, "Erro: malloc pistas\n"); exit(EXIT_FAILURE); }
+    *total = n;
+    return pistas;
+}
+
+/* Histograma do tamanho das cadeias ao distribuir as chaves em 'baldes' */
+void imprimirDistribuicao(const char *nome, const unsigned long *hashes, int n, size_t baldes, int usarModulo) {
+    int *cont = (int*) calloc(baldes, sizeof(int));
+    if (!cont) { fprintf(stderr, "Erro: malloc histograma\n"); exit(EXIT_FAILURE); }
+    for (int i = 0; i < n; i++)
+        cont[usarModulo ? hashes[i] % baldes : hashes[i] & (baldes - 1)]++;
+
+    int histograma[9] = {0}, maximo = 0;
+    for (size_t b = 0; b < baldes; b++) {
+        histograma[cont[b] < 8 ? cont[b] : 8]++;
+        if (cont[b] > maximo) maximo = cont[b];
     }
+    printf("%-26s", nome);
+    for (int k = 0; k < 9; k++) printf(" %8d", histograma[k]);
+    printf(" %8d\n", maximo);
+    free(cont);
+}
+
+void benchmarkHash(const char *arquivo) {
+    int n;
+    char **pistas = carregarPistasBenchmark(arquivo, &n);
+    if (n == 0) {
+        printf("Nenhuma pista para medir.\n");
+        free(pistas);
+        return;
+    }
+    size_t *lens = (size_t*) malloc((size_t)n * sizeof(size_t));
+    unsigned long *hDjb2 = (unsigned long*) calloc((size_t)n, sizeof(unsigned long));
+    unsigned long *hNovo = (unsigned long*) calloc((size_t)n, sizeof(unsigned long));
+    if (!lens || !hDjb2 || !hNovo) { fprintf(stderr, "Erro: malloc benchmark\n"); exit(EXIT_FAILURE); }
+    size_t bytes = 0;
+    for (int i = 0; i < n; i++) bytes += lens[i] = strlen(pistas[i]);
+
+    // vazão: várias passadas até somar ~50 MB por hash
+    int passadas = (int)(50000000 / (bytes + 1)) + 1;
+    volatile unsigned long soma = 0;
+    long long t0 = agoraNs();
+    for (int r = 0; r < passadas; r++)
+        for (int i = 0; i < n; i++) soma += hashDjb2(pistas[i]);
+    long long t1 = agoraNs();
+    for (int r = 0; r < passadas; r++)
+        for (int i = 0; i < n; i++) soma += hashTextoChave(pistas[i], lens[i]);
+    long long t2 = agoraNs();
+
+    double total = (double)bytes * passadas, chamadas = (double)n * passadas;
+    printf("\n--- Benchmark de hash: %d pistas, %.1f bytes em média ---\n", n, (double)bytes / n);
+    printf("%-26s %12s %12s\n", "HASH", "MB/s", "NS/PISTA");
+    printf("%-26s %12.1f %12.2f\n", "djb2", total / ((t1 - t0) / 1e3), (t1 - t0) / chamadas);
+    printf("%-26s %12.1f %12.2f\n", "8 bytes/iteração + semente", total / ((t2 - t1) / 1e3), (t2 - t1) / chamadas);
+
+    // distribuição: mesma quantidade de baldes (potência de 2, carga <= 0,8)
+    for (int i = 0; i < n; i++) {
+        hDjb2[i] = hashDjb2(pistas[i]);
+        hNovo[i] = hashTextoChave(pistas[i], lens[i]);
+    }
+    size_t baldes = HASH_CAPACIDADE_INICIAL;
+    while ((size_t)n * HASH_CARGA_MAX_DEN > baldes * HASH_CARGA_MAX_NUM) baldes *= 2;
+    printf("\nTamanho das cadeias (quantidade de baldes com 0..7 e 8+ chaves):\n");
+    printf("%-26s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s\n",
+           "HASH / BALDES", "0", "1", "2", "3", "4", "5", "6", "7", "8+", "MAX");
+    imprimirDistribuicao("djb2 % 101 (original)", hDjb2, n, 101, 1);
+    imprimirDistribuicao("djb2 & máscara", hDjb2, n, baldes, 0);
+    imprimirDistribuicao("semente & máscara", hNovo, n, baldes, 0);
+    printf("(%zu baldes na máscara)\n", baldes);
+
+    // sondagens na tabela Robin Hood real
+    TabelaHash tabela;
+    inicializarHash(&tabela);
+    for (int i = 0; i < n; i++) inserirNaHash(&tabela, pistas[i], "x");
+    unsigned long somaDist = 0;
+    uint32_t maxDist = 0;
+    for (size_t i = 0; i < tabela.pistas.capacidade; i++) {
+        uint32_t d = tabela.pistas.entradas[i].distancia;
+        if (d == 0) continue;
+        somaDist += d;
+        if (d > maxDist) maxDist = d;
+    }
+    printf("\nTabela Robin Hood: %zu chaves, capacidade %zu, sondagens média %.2f / máx %u\n",
+           tabela.pistas.total, tabela.pistas.capacidade,
+           tabela.pistas.total ? (double)somaDist / tabela.pistas.total : 0.0, maxDist);
+    liberarHash(&tabela);
+
+    (void)soma;
+    for (int i = 0; i < n; i++) free(pistas[i]);
+    free(pistas);
+    free(lens);
+    free(hDjb2);
+    free(hNovo);
 }
 
 /* -------------------------
-   main: monta mansão, tabela hash e inicia o jogo
+   main: carrega a mansão, a tabela hash e inicia o jogo
+   Uso: detectiveQuestMestre [arquivo_da_mansao]
+        detectiveQuestMestre --resolver [arquivo_da_mansao]
+        detectiveQuestMestre --resolver-paralelo <threads> [arquivo_da_mansao]
+        detectiveQuestMestre --caminho <origem> <destino> [arquivo_da_mansao]
+        detectiveQuestMestre --buscar <trecho ou prefixo*> [arquivo_da_mansao]
+        detectiveQuestMestre --memoria-pistas [arquivo_da_mansao]
+        detectiveQuestMestre --gerar-mansao <salas> <arquivo> [aleatoria|balanceada|corredor]
+        detectiveQuestMestre --bench-hash [arquivo_de_pistas]
    -------------------------*/
-int main(void) {
-    /* --- Criação manual do mapa da mansão (árvore binária) --- */
-    Sala *hall = criarSala("Hall de Entrada", "Pegadas enluvadas no carpete");
-    Sala *salaEstar = criarSala("Sala de Estar", "Perfume caro com resíduo de pó");
-    Sala *cozinha = criarSala("Cozinha", "Faca faltando no jogo de talheres");
-    Sala *biblioteca = criarSala("Biblioteca", "Página arrancada de um testamento");
-    Sala *jardim = criarSala("Jardim Interno", "Terra fresca com impressão de sapato pequeno");
-    Sala *despensa = criarSala("Despensa", "Rótulo de veneno rasgado");
-    Sala *areaServico = criarSala("Área de Serviço", "Toalha com manchas de óleo");
-    Sala *sotao = criarSala("Sótão", "Peça de roupa com bordado inicial 'M.'");
-
-    // montar ligações
-    hall->esquerda = salaEstar;
-    hall->direita  = cozinha;
-
-    salaEstar->esquerda = biblioteca;
-    salaEstar->direita  = jardim;
-
-    cozinha->esquerda = despensa;
-    cozinha->direita  = areaServico;
-
-    biblioteca->esquerda = sotao; // só para criar profundidade (pode ser NULL)
-
-    /* --- Criar tabela hash e popular associação pista -> suspeito --- */
-    HashNode *hash[HASH_SIZE];
+
+// Mostra as formas de uso em stderr; devolve o código de saída de erro
+int exibirUso(const char *programa) {
+    fprintf(stderr,
+            "Uso: %s [arquivo_da_mansao]\n"
+            "     %s --resolver [arquivo_da_mansao]\n"
+            "     %s --resolver-paralelo <threads> [arquivo_da_mansao]\n"
+            "     %s --caminho <origem> <destino> [arquivo_da_mansao]\n"
+            "     %s --buscar <trecho ou prefixo*> [arquivo_da_mansao]\n"
+            "     %s --memoria-pistas [arquivo_da_mansao]\n"
+            "     %s --gerar-mansao <salas> <arquivo> [aleatoria|balanceada|corredor]\n"
+            "     %s --bench-hash [arquivo_de_pistas]\n",
+            programa, programa, programa, programa, programa, programa, programa, programa);
+    return EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[]) {
+    /* semente do hash por processo: relógio + endereço de pilha (ASLR) */
+    definirSementeChave((uint64_t)time(NULL) ^ (uint64_t)agoraNs() ^ (uint64_t)(uintptr_t)&argc);
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-hash") == 0) {
+        benchmarkHash(argc >= 3 ? argv[2] : NULL);
+        return 0;
+    }
+    // opções com argumentos obrigatórios: faltando algum, o uso é mostrado
+    // (em vez de o nome da opção ser tomado como arquivo da mansão)
+    if (argc >= 2 && ((strcmp(argv[1], "--gerar-mansao") == 0 && argc < 4) ||
+                      (strcmp(argv[1], "--caminho") == 0 && argc < 4) ||
+                      (strcmp(argv[1], "--buscar") == 0 && argc < 3))) {
+        fprintf(stderr, "%s: faltam argumentos.\n", argv[1]);
+        return exibirUso(argv[0]);
+    }
+    if (argc >= 4 && strcmp(argv[1], "--gerar-mansao") == 0) {
+        long long t0 = agoraNs();
+        if (!gerarMansao(argv[3], atoi(argv[2]), argc >= 5 ? argv[4] : "aleatoria")) return EXIT_FAILURE;
+        printf("Mansão gravada em \"%s\" em %.3f ms.\n", argv[3], (agoraNs() - t0) / 1e6);
+        return 0;
+    }
+    const char *consulta = argc >= 3 && strcmp(argv[1], "--buscar") == 0 ? argv[2] : NULL;
+    int memoria = argc >= 2 && strcmp(argv[1], "--memoria-pistas") == 0;
+    int resolver = consulta != NULL || memoria || (argc >= 2 && strcmp(argv[1], "--resolver") == 0);
+    int threads = 0, argMansao = consulta ? 3 : 1 + resolver;
+    if (argc >= 2 && strcmp(argv[1], "--resolver-paralelo") == 0) {
+        // a contagem é obrigatória: sem ela o arquivo viraria o número de threads
+        char *fim = NULL;
+        long n = argc >= 3 ? strtol(argv[2], &fim, 10) : 0;
+        if (argc < 3 || fim == argv[2] || *fim != '\0' || n < 1 || n > INT32_MAX) {
+            fprintf(stderr, "--resolver-paralelo: número de threads inválido ou ausente.\n");
+            return exibirUso(argv[0]);
+        }
+        resolver = 1;
+        threads = (int)n;
+        argMansao = 3;
+    }
+    int consultarCaminho = argc >= 4 && strcmp(argv[1], "--caminho") == 0;
+    if (consultarCaminho) argMansao = 4;
+    const char *arquivoMansao = argc > argMansao ? argv[argMansao] : NULL;
+
+    /* --- Mansão (árvore de salas) e associação pista -> suspeito --- */
+    TabelaHash tabela;
+    TabelaHash *hash = &tabela;
     inicializarHash(hash);
 
-    // Mapeamentos (definidos estáticamente)
-    inserirNaHash(hash, "Pegadas enluvadas no carpete", "Mariana");
-    inserirNaHash(hash, "Perfume caro com resíduo de pó", "Roberto");
-    inserirNaHash(hash, "Faca faltando no jogo de talheres", "Carlos");
-    inserirNaHash(hash, "Página arrancada de um testamento", "Mariana");
-    inserirNaHash(hash, "Terra fresca com impressão de sapato pequeno", "Ana");
-    inserirNaHash(hash, "Rótulo de veneno rasgado", "Carlos");
-    inserirNaHash(hash, "Toalha com manchas de óleo", "Roberto");
-    inserirNaHash(hash, "Peça de roupa com bordado inicial 'M.'", "Mariana");
+    Mansao mansao;
+    long long t0 = agoraNs();
+    int carregada = arquivoMansao ? carregarMansao(&mansao, arquivoMansao, hash) : carregarMansaoPadrao(&mansao, hash);
+    if (!carregada) {
+        liberarHash(hash);
+        return EXIT_FAILURE;
+    }
+
+    /* --- Pistas coletadas: AVL + índice de trigramas (começa vazia) --- */
+    ColecaoPistas pistas;
+    inicializarColecao(&pistas);
 
-    /* --- BST de pistas coletadas (começa vazia) --- */
-    PistaNode *pistasColetadas = NULL;
+    if (resolver) {
+        printf("Mansão carregada: %d sala(s), %d suspeito(s) em %.3f ms.\n",
+               mansao.totalSalas, hash->totalSuspeitos, (agoraNs() - t0) / 1e6);
+        ResultadoSolucao r = threads > 0 ? resolverMansaoParalelo(&mansao, &pistas, hash, threads)
+                                         : resolverMansao(&mansao, &pistas, hash);
+        if (consulta) { // todas as pistas coletadas: mede a busca sem a impressão
+            long long t1 = agoraNs();
+            int achadas = buscarPistas(&pistas, consulta, ignorarPista, NULL);
+            long long t2 = agoraNs();
+            buscarPistas(&pistas, consulta, imprimirPista, NULL);
+            printf("%d de %d pista(s) para \"%s\" em %.3f ms.\n",
+                   achadas, pistas.total, consulta, (t2 - t1) / 1e6);
+        } else if (memoria) {
+            relatorioMemoriaPistas(&pistas, hash);
+        } else {
+            exibirResultadoSolucao(&r, &mansao, hash);
+        }
+        liberarColecao(&pistas);
+        liberarHash(hash);
+        liberarMansao(&mansao);
+        return 0;
+    }
+
+    /* --- Índice de caminhos (pai/profundidade + LCA) --- */
+    IndiceCaminhos caminhos;
+    t0 = agoraNs();
+    construirIndiceCaminhos(&caminhos, &mansao);
+    if (consultarCaminho) {
+        int32_t origem = localizarSala(&caminhos, argv[2]), destino = localizarSala(&caminhos, argv[3]);
+        printf("Índice de caminhos: %d sala(s) em %.3f ms.\n", mansao.totalSalas, (agoraNs() - t0) / 1e6);
+        if (origem == SEM_SALA || destino == SEM_SALA)
+            printf("Sala ou pista não encontrada: \"%s\".\n", origem == SEM_SALA ? argv[2] : argv[3]);
+        else
+            exibirCaminho(&caminhos, origem, destino);
+        liberarIndiceCaminhos(&caminhos);
+        liberarHash(hash);
+        liberarMansao(&mansao);
+        return 0;
+    }
 
     printf("============================================\n");
     printf("   Detective Quest — Investigação Final\n");
     printf("============================================\n");
-    printf("Você começa no Hall de Entrada. Explore a mansão e colete pistas.\n");
+    printf("Você começa em %s (%d sala(s)). Explore a mansão e colete pistas.\n",
+           mansao.textos + mansao.salas[0].nome, mansao.totalSalas);
 
     /* --- Exploração interativa (coleta automática de pistas nas salas visitadas) --- */
-    explorarSalas(hall, &pistasColetadas, hash);
+    explorarSalas(&mansao, &pistas, hash, &caminhos);
 
     /* --- Fase final: mostrar pistas coletadas e pedir acusação --- */
-    verificarSuspeitoFinal(pistasColetadas, hash);
+    verificarSuspeitoFinal(pistas.raiz, hash);
 
     /* --- Limpeza de memória --- */
-    liberarBST(pistasColetadas);
+    liberarColecao(&pistas);
     liberarHash(hash);
-    // liberar salas (árvore de salas) - liberação simples em pós-ordem recursiva
-    // função de liberação das salas:
-    // (implementei inline para manter código compacto)
-    // usar pilha/recursão simples:
-    // liberar sala tree
-    // cria pequena função lambda-like:
-    {
-        // função local: liberar salas recursivamente
-        void liberarSalasRec(Sala *r) {
-            if (!r) return;
-            liberarSalasRec(r->esquerda);
-            liberarSalasRec(r->direita);
-            free(r);
-        }
-        liberarSalasRec(hall);
-    }
+    liberarIndiceCaminhos(&caminhos);
+    liberarMansao(&mansao);
 
     printf("\nObrigado por jogar. Fim da simulação.\n");
     return 0;
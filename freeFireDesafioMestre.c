@@ -2,27 +2,50 @@
   Sistema de Prioritização e Montagem de Componentes
   - Implementa Bubble Sort (por nome), Insertion Sort (por tipo),
     Selection Sort (por prioridade).
-  - Mede comparações e tempo (clock()).
+  - Mede comparações, trocas, bytes movidos e tempo (relógio monotônico).
+  - Modo benchmark: várias repetições sobre cópias novas, min/mediana/p99,
+    varrendo n e distribuições de entrada.
   - Busca binária por nome (aplicável apenas após ordenação por nome).
-  - Entrada de até 20 componentes usando fgets().
+  - Índice Eytzinger (layout BFS) com descida sem desvios e comparação
+    por prefixo de 8 bytes, comparado lado a lado com a busca binária.
+  - Entrada de componentes usando fgets() (vetor dinâmico, cresce sob demanda).
+  - Importação/exportação em lote via CSV (nome,tipo,prioridade).
+  - Nomes guardados como chaves com hash/prefixo pré-calculados (chaveString.h).
+  - Fila de montagem (heap 4-ário por prioridade, desempate por ordem de
+    cadastro): próximo componente em O(log n) sem reordenar o vetor.
   - Interface por menu.
 */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <time.h>
+#include "csvRapido.h"
+#include "chaveString.h"
 
-#define MAX_COMPONENTES 20
+#define MAX_COMPONENTES 20   // capacidade inicial do vetor (dobra quando enche)
+#define MAX_EXIBICAO 50      // linhas mostradas por mostrarComponentes()
+#define TAM_LOTE_CSV 1024    // componentes validados antes de cada cópia em lote
+#define ARIDADE_HEAP 4       // filhos por nó na fila de montagem
 #define NAME_LEN 30
 #define TYPE_LEN 20
 
+typedef CHAVE_STRING(NAME_LEN) NomeComponente;
+
 typedef struct {
-    char nome[NAME_LEN];
+    NomeComponente nome;
     char tipo[TYPE_LEN];
     int prioridade; // 1 a 10
 } Componente;
 
+// Métricas coletadas pelos algoritmos de ordenação
+typedef struct {
+    long comparacoes;
+    long trocas;           // trocas (ou deslocamentos, no insertion sort)
+    long long bytesMovidos; // bytes copiados entre posições do vetor
+} MetricasOrdenacao;
+
 /* ---------- Funções utilitárias ---------- */
 
 // Remove '\n' vindo de fgets, se houver
@@ -63,31 +86,37 @@ void mostrarComponentes(Componente arr[], int n) {
         return;
     }
     printf("%-3s %-30s %-15s %-10s\n", "#", "NOME", "TIPO", "PRIORIDADE");
-    for (int i = 0; i < n; i++) {
+    int limite = n < MAX_EXIBICAO ? n : MAX_EXIBICAO;
+    for (int i = 0; i < limite; i++) {
         printf("%-3d %-30s %-15s %-10d\n",
-               i+1, arr[i].nome, arr[i].tipo, arr[i].prioridade);
+               i+1, arr[i].nome.texto, arr[i].tipo, arr[i].prioridade);
     }
+    if (n > limite) printf("... (mais %d componentes não exibidos)\n", n - limite);
 }
 
 /* ---------- Algoritmos de ordenação ---------- */
 
 /*
   Bubble Sort por nome (string)
-  - compara nomes com strcmp
-  - conta comparações (incrementa *comparacoes)
-  - faz troca de structs completas
+  - compara nomes pelo prefixo pré-calculado (strcmp só em empate)
+  - conta comparações e trocas em *m
+  - faz troca de structs completas (3 cópias por troca)
 */
-void bubbleSortNome(Componente arr[], int n, long *comparacoes) {
-    *comparacoes = 0;
+void bubbleSortNome(Componente arr[], int n, MetricasOrdenacao *m) {
+    m->comparacoes = 0;
+    m->trocas = 0;
+    m->bytesMovidos = 0;
     if (n <= 1) return;
     for (int i = 0; i < n - 1; i++) {
         int trocou = 0;
         for (int j = 0; j < n - i - 1; j++) {
-            (*comparacoes)++;
-            if (strcmp(arr[j].nome, arr[j+1].nome) > 0) {
+            m->comparacoes++;
+            if (COMPARAR_CHAVES(arr[j].nome, arr[j+1].nome) > 0) {
                 Componente tmp = arr[j];
                 arr[j] = arr[j+1];
                 arr[j+1] = tmp;
+                m->trocas++;
+                m->bytesMovidos += 3 * (long long)sizeof(Componente);
                 trocou = 1;
             }
         }
@@ -98,38 +127,45 @@ void bubbleSortNome(Componente arr[], int n, long *comparacoes) {
 /*
   Insertion Sort por tipo (string)
   - compara tipos com strcmp
-  - conta comparações em *comparacoes
+  - conta comparações e deslocamentos em *m
 */
-void insertionSortTipo(Componente arr[], int n, long *comparacoes) {
-    *comparacoes = 0;
+void insertionSortTipo(Componente arr[], int n, MetricasOrdenacao *m) {
+    m->comparacoes = 0;
+    m->trocas = 0;
+    m->bytesMovidos = 0;
     for (int i = 1; i < n; i++) {
         Componente chave = arr[i];
         int j = i - 1;
         // mover enquanto tipo[j] > chave.tipo
         while (j >= 0) {
-            (*comparacoes)++;
+            m->comparacoes++;
             if (strcmp(arr[j].tipo, chave.tipo) > 0) {
                 arr[j+1] = arr[j];
+                m->trocas++;
+                m->bytesMovidos += (long long)sizeof(Componente);
                 j--;
             } else {
                 break;
             }
         }
         arr[j+1] = chave;
+        m->bytesMovidos += 2 * (long long)sizeof(Componente); // cópia da chave e reposição
     }
 }
 
 /*
   Selection Sort por prioridade (int)
   - Ordena em ordem crescente de prioridade (1 = mais urgente)
-  - Conta comparações em *comparacoes (comparação entre prioridades)
+  - Conta comparações (entre prioridades) e trocas em *m
 */
-void selectionSortPrioridade(Componente arr[], int n, long *comparacoes) {
-    *comparacoes = 0;
+void selectionSortPrioridade(Componente arr[], int n, MetricasOrdenacao *m) {
+    m->comparacoes = 0;
+    m->trocas = 0;
+    m->bytesMovidos = 0;
     for (int i = 0; i < n - 1; i++) {
         int menor = i;
         for (int j = i + 1; j < n; j++) {
-            (*comparacoes)++;
+            m->comparacoes++;
             if (arr[j].prioridade < arr[menor].prioridade) {
                 menor = j;
             }
@@ -138,6 +174,8 @@ void selectionSortPrioridade(Componente arr[], int n, long *comparacoes) {
             Componente tmp = arr[i];
             arr[i] = arr[menor];
             arr[menor] = tmp;
+            m->trocas++;
+            m->bytesMovidos += 3 * (long long)sizeof(Componente);
         }
     }
 }
@@ -146,15 +184,17 @@ void selectionSortPrioridade(Componente arr[], int n, long *comparacoes) {
 /*
   retorna índice do componente encontrado ou -1 se não encontrado
   também registra número de comparações em *comparacoes
-  usa strcmp para comparar strings
+  compara pelas chaves pré-calculadas (prefixo de 8 bytes, strcmp no restante)
 */
 int buscaBinariaPorNome(Componente arr[], int n, const char chave[], long *comparacoes) {
     int esquerda = 0, direita = n - 1;
+    MetaChave meta;
+    preencherMetaChave(&meta, chave);
     *comparacoes = 0;
     while (esquerda <= direita) {
         int meio = (esquerda + direita) / 2;
         (*comparacoes)++;
-        int cmp = strcmp(chave, arr[meio].nome);
+        int cmp = compararChaves(&meta, chave, &arr[meio].nome.meta, arr[meio].nome.texto);
         if (cmp == 0) return meio;
         else if (cmp > 0) esquerda = meio + 1;
         else direita = meio - 1;
@@ -162,28 +202,679 @@ int buscaBinariaPorNome(Componente arr[], int n, const char chave[], long *compa
     return -1;
 }
 
+/* ---------- Índice Eytzinger (layout BFS) para busca por nome ---------- */
+/*
+  O vetor ordenado por nome é copiado para um índice em ordem de busca em
+  largura: raiz na posição 1, filhos de k em 2k e 2k+1. Cada posição guarda
+  o prefixo de 8 bytes do nome (já calculado na chave) e o índice do
+  componente no vetor ordenado.
+  - os primeiros níveis ficam juntos no começo do vetor (bom para cache)
+  - a descida não depende de desvio: k = 2k + (nó < chave)
+  - strcmp só é chamado quando os prefixos empatam
+*/
+typedef struct {
+    uint64_t *prefixos; // prefixos[1..n] em ordem BFS
+    int *indices;       // indices[1..n]: posição no vetor ordenado
+    int n;
+} IndiceEytzinger;
+
+// Percorre em ordem as posições BFS, consumindo o vetor ordenado
+int preencherEytzinger(IndiceEytzinger *idx, Componente arr[], int i, int k) {
+    if (k <= idx->n) {
+        i = preencherEytzinger(idx, arr, i, 2 * k);
+        idx->prefixos[k] = arr[i].nome.meta.prefixo;
+        idx->indices[k] = i++;
+        i = preencherEytzinger(idx, arr, i, 2 * k + 1);
+    }
+    return i;
+}
+
+// Constrói o índice a partir de um vetor já ordenado por nome
+void construirIndiceEytzinger(IndiceEytzinger *idx, Componente arr[], int n) {
+    idx->n = n;
+    // alinhado a 64 bytes: os 16 prefixos de um bloco de descendentes
+    // ocupam exatamente duas linhas de cache (aligned_alloc pede múltiplo de 64)
+    size_t bytesPrefixos = ((size_t)(n + 1) * sizeof(uint64_t) + 63) & ~(size_t)63;
+    idx->prefixos = (uint64_t*) aligned_alloc(64, bytesPrefixos);
+    idx->indices = (int*) malloc((size_t)(n + 1) * sizeof(int));
+    if (!idx->prefixos || !idx->indices) {
+        fprintf(stderr, "Erro: falha na alocação do índice Eytzinger.\n");
+        exit(EXIT_FAILURE);
+    }
+    preencherEytzinger(idx, arr, 0, 1);
+}
+
+void liberarIndiceEytzinger(IndiceEytzinger *idx) {
+    free(idx->prefixos);
+    free(idx->indices);
+    idx->prefixos = NULL;
+    idx->indices = NULL;
+    idx->n = 0;
+}
+
+/*
+  Busca no índice Eytzinger.
+  - cada nível conta uma comparação (prefixo, e strcmp só em empate)
+  - ao final, k aponta para o menor nome >= chave (ou 0 se não houver)
+  retorna índice no vetor ordenado ou -1 se não encontrado
+*/
+int buscaEytzingerPorNome(const IndiceEytzinger *idx, Componente arr[], const char chave[], long *comparacoes) {
+    MetaChave meta;
+    preencherMetaChave(&meta, chave);
+    uint64_t p = meta.prefixo;
+    int n = idx->n;
+    int k = 1;
+    *comparacoes = 0;
+    while (k <= n) {
+        // busca antecipada dos 16 descendentes 4 níveis abaixo, prefixos[16k .. 16k+15]:
+        // 128 bytes, duas linhas de cache; só endereços dentro do vetor
+        size_t bloco = 16 * (size_t)k;
+        if (bloco <= (size_t)n) __builtin_prefetch(idx->prefixos + bloco);
+        if (bloco + 8 <= (size_t)n) __builtin_prefetch(idx->prefixos + bloco + 8);
+        (*comparacoes)++;
+        uint64_t pk = idx->prefixos[k];
+        int menor = pk < p;
+        if (pk == p) {
+            const NomeComponente *nome = &arr[idx->indices[k]].nome;
+            menor = compararChaves(&nome->meta, nome->texto, &meta, chave) < 0;
+        }
+        k = 2 * k + menor;
+    }
+    // desfaz as descidas à direita finais: volta ao último ancestral onde fomos à esquerda
+    k >>= __builtin_ffs(~k);
+    if (k == 0 || idx->prefixos[k] != p) return -1;
+    (*comparacoes)++;
+    const NomeComponente *nome = &arr[idx->indices[k]].nome;
+    if (chavesIguais(&nome->meta, nome->texto, &meta, chave)) return idx->indices[k];
+    return -1;
+}
+
+/* ---------- Relógio monotônico em nanossegundos ---------- */
+long long agoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* ---------- Benchmark: busca binária x Eytzinger ---------- */
+
+// Gerador pseudoaleatório simples (xorshift64) para dados de teste reprodutíveis
+uint64_t proximoAleatorio(uint64_t *estado) {
+    uint64_t x = *estado;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *estado = x;
+    return x;
+}
+
+// Preenche 'nome' com letras minúsculas aleatórias (6 a NAME_LEN-1 caracteres)
+void gerarNomeAleatorio(char *nome, uint64_t *estado) {
+    int len = 6 + (int)(proximoAleatorio(estado) % (NAME_LEN - 7));
+    for (int i = 0; i < len; i++) nome[i] = (char)('a' + proximoAleatorio(estado) % 26);
+    nome[len] = '\0';
+}
+
+int compararComponentesPorNome(const void *a, const void *b) {
+    return COMPARAR_CHAVES(((const Componente*)a)->nome, ((const Componente*)b)->nome);
+}
+
+/*
+  Gera n componentes com nomes aleatórios, ordena por nome e executa
+  'consultas' buscas (metade de nomes existentes, metade ausentes) com
+  cada algoritmo, reportando comparações médias e ns por busca.
+*/
+void benchmarkBuscas(int n, int consultas) {
+    if (n <= 0 || consultas <= 0) {
+        printf("Parâmetros inválidos.\n");
+        return;
+    }
+    Componente *arr = (Componente*) malloc((size_t)n * sizeof(Componente));
+    char (*chaves)[NAME_LEN] = malloc((size_t)consultas * NAME_LEN);
+    if (!arr || !chaves) {
+        fprintf(stderr, "Erro: falha na alocação do benchmark.\n");
+        exit(EXIT_FAILURE);
+    }
+    uint64_t estado = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < n; i++) {
+        char nome[NAME_LEN];
+        gerarNomeAleatorio(nome, &estado);
+        DEFINIR_CHAVE(arr[i].nome, nome);
+        strcpy(arr[i].tipo, "teste");
+        arr[i].prioridade = 1 + (int)(proximoAleatorio(&estado) % 10);
+    }
+    qsort(arr, (size_t)n, sizeof(Componente), compararComponentesPorNome);
+    for (int i = 0; i < consultas; i++) {
+        if (i % 2 == 0) strcpy(chaves[i], arr[proximoAleatorio(&estado) % (uint64_t)n].nome.texto);
+        else gerarNomeAleatorio(chaves[i], &estado);
+    }
+
+    IndiceEytzinger idx;
+    construirIndiceEytzinger(&idx, arr, n);
+
+    long comp, totalBinaria = 0, totalEytzinger = 0;
+    int achadosBinaria = 0, achadosEytzinger = 0;
+
+    long long t0 = agoraNs();
+    for (int i = 0; i < consultas; i++) {
+        achadosBinaria += buscaBinariaPorNome(arr, n, chaves[i], &comp) >= 0;
+        totalBinaria += comp;
+    }
+    long long t1 = agoraNs();
+    for (int i = 0; i < consultas; i++) {
+        achadosEytzinger += buscaEytzingerPorNome(&idx, arr, chaves[i], &comp) >= 0;
+        totalEytzinger += comp;
+    }
+    long long t2 = agoraNs();
+
+    printf("\n--- Benchmark de busca: %d componentes, %d consultas ---\n", n, consultas);
+    printf("%-20s %-12s %-18s %-12s\n", "ALGORITMO", "ACHADOS", "COMPARAÇÕES/BUSCA", "NS/BUSCA");
+    printf("%-20s %-12d %-18.2f %-12.1f\n", "Binária clássica", achadosBinaria,
+           (double)totalBinaria / consultas, (double)(t1 - t0) / consultas);
+    printf("%-20s %-12d %-18.2f %-12.1f\n", "Eytzinger", achadosEytzinger,
+           (double)totalEytzinger / consultas, (double)(t2 - t1) / consultas);
+    if (achadosBinaria != achadosEytzinger)
+        printf("ATENÇÃO: as buscas divergiram no número de achados!\n");
+
+    liberarIndiceEytzinger(&idx);
+    free(chaves);
+    free(arr);
+}
+
 /* ---------- Medição de tempo genérica ---------- */
 /*
-  Executa a rotina passada (que deve ser do tipo void func(Componente[], int, long *))
-  e mede tempo gasto em segundos, além de capturar comparações retornadas através do ponteiro compPtr.
+  Executa a rotina passada (que deve ser do tipo void func(Componente[], int, MetricasOrdenacao *))
+  e mede o tempo de parede em segundos com relógio monotônico (resolução de ns),
+  além de capturar as métricas retornadas através do ponteiro m.
+*/
+typedef void (*SortFunc)(Componente[], int, MetricasOrdenacao *);
+
+double medirTempoOrdenacao(SortFunc func, Componente arr[], int n, MetricasOrdenacao *m) {
+    long long inicio = agoraNs();
+    func(arr, n, m);
+    long long fim = agoraNs();
+    return (double)(fim - inicio) / 1e9;
+}
+
+/* ---------- Benchmark de ordenação (várias repetições, varredura de n) ---------- */
+
+#define BENCH_N_MIN 10
+#define BENCH_ORCAMENTO_NS 2000000000LL // tempo máximo por célula (algoritmo, entrada, n)
+
+typedef enum { ENTRADA_ALEATORIA, ENTRADA_ORDENADA, ENTRADA_INVERTIDA, ENTRADA_DUPLICADAS, TOTAL_ENTRADAS } TipoEntrada;
+
+const char *nomesEntrada[TOTAL_ENTRADAS] = {"aleatoria", "ordenada", "invertida", "duplicadas"};
+
+int compararComponentesPorTipo(const void *a, const void *b) {
+    return strcmp(((const Componente*)a)->tipo, ((const Componente*)b)->tipo);
+}
+
+int compararComponentesPorPrioridade(const void *a, const void *b) {
+    int pa = ((const Componente*)a)->prioridade, pb = ((const Componente*)b)->prioridade;
+    return (pa > pb) - (pa < pb);
+}
+
+// Algoritmo avaliado + comparador da mesma chave (usado para gerar entradas ordenadas)
+typedef struct {
+    const char *nome;
+    SortFunc func;
+    int (*comparar)(const void *, const void *);
+} AlgoritmoBench;
+
+/*
+  Gera n componentes conforme a distribuição pedida, em relação à chave do algoritmo:
+  - aleatoria: chaves aleatórias
+  - ordenada / invertida: chaves aleatórias já ordenadas (ou em ordem reversa)
+  - duplicadas: chaves sorteadas entre apenas 4 valores
+*/
+void gerarEntradaBench(Componente arr[], int n, TipoEntrada entrada, const AlgoritmoBench *alg, uint64_t *estado) {
+    const char *poucosNomes[4] = {"antena", "bateria", "cabo", "motor"};
+    for (int i = 0; i < n; i++) {
+        if (entrada == ENTRADA_DUPLICADAS) {
+            int v = (int)(proximoAleatorio(estado) % 4);
+            DEFINIR_CHAVE(arr[i].nome, poucosNomes[v]);
+            strcpy(arr[i].tipo, poucosNomes[v]);
+            arr[i].prioridade = 1 + v;
+        } else {
+            char nome[NAME_LEN];
+            gerarNomeAleatorio(nome, estado);
+            DEFINIR_CHAVE(arr[i].nome, nome);
+            gerarNomeAleatorio(nome, estado);
+            snprintf(arr[i].tipo, TYPE_LEN, "%s", nome); // trunca em TYPE_LEN-1
+            arr[i].prioridade = 1 + (int)(proximoAleatorio(estado) % 10);
+        }
+    }
+    if (entrada == ENTRADA_ORDENADA || entrada == ENTRADA_INVERTIDA)
+        qsort(arr, (size_t)n, sizeof(Componente), alg->comparar);
+    if (entrada == ENTRADA_INVERTIDA) {
+        for (int i = 0, j = n - 1; i < j; i++, j--) {
+            Componente tmp = arr[i];
+            arr[i] = arr[j];
+            arr[j] = tmp;
+        }
+    }
+}
+
+int compararLongLong(const void *a, const void *b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+/*
+  Para cada algoritmo e distribuição, varre n = 10, 100, ..., nMax.
+  Cada célula roda até 'repeticoes' vezes sobre cópias novas da mesma entrada
+  (a cópia não entra no tempo), parando antes se o orçamento de tempo estourar.
+  Tamanhos cuja estimativa (pelo crescimento observado entre os dois últimos n)
+  passe do orçamento são pulados.
+*/
+void benchmarkOrdenacao(int repeticoes, long nMax) {
+    if (repeticoes <= 0 || nMax < BENCH_N_MIN) {
+        printf("Parâmetros inválidos.\n");
+        return;
+    }
+    AlgoritmoBench algoritmos[] = {
+        {"Bubble/nome", bubbleSortNome, compararComponentesPorNome},
+        {"Insertion/tipo", insertionSortTipo, compararComponentesPorTipo},
+        {"Selection/prio", selectionSortPrioridade, compararComponentesPorPrioridade},
+    };
+    int totalAlgoritmos = (int)(sizeof(algoritmos) / sizeof(algoritmos[0]));
+
+    // base/copia crescem só até o maior n realmente medido (células puladas não alocam)
+    Componente *base = NULL, *copia = NULL;
+    long capacidade = 0;
+    long long *amostras = (long long*) malloc((size_t)repeticoes * sizeof(long long));
+    if (!amostras) {
+        fprintf(stderr, "Erro: falha na alocação do benchmark.\n");
+        return;
+    }
+
+    printf("\n%-15s %-11s %-9s %-5s %-12s %-12s %-12s %-13s %-12s %-14s\n",
+           "ALGORITMO", "ENTRADA", "N", "REP", "MIN(us)", "MEDIANA(us)", "P99(us)",
+           "COMPARACOES", "TROCAS", "BYTES");
+
+    for (int a = 0; a < totalAlgoritmos; a++) {
+        for (int e = 0; e < TOTAL_ENTRADAS; e++) {
+            long long medianaAnterior = 0;
+            double crescimento = 10.0; // suposição inicial: linear
+            for (long n = BENCH_N_MIN; n <= nMax; n *= 10) {
+                if (medianaAnterior > 0 && medianaAnterior * crescimento > BENCH_ORCAMENTO_NS) {
+                    printf("%-15s %-11s %-9ld pulado (estimativa %.1f s)\n", algoritmos[a].nome,
+                           nomesEntrada[e], n, medianaAnterior * crescimento / 1e9);
+                    break; // tamanhos maiores também estourariam
+                }
+                if (n > capacidade) {
+                    Componente *novaBase = (Componente*) realloc(base, (size_t)n * sizeof(Componente));
+                    if (novaBase) base = novaBase;
+                    Componente *novaCopia = novaBase ? (Componente*) realloc(copia, (size_t)n * sizeof(Componente)) : NULL;
+                    if (novaCopia) copia = novaCopia;
+                    if (!novaBase || !novaCopia) {
+                        fprintf(stderr, "Erro: falha na alocação do benchmark (n = %ld muito grande?).\n", n);
+                        free(base);
+                        free(copia);
+                        free(amostras);
+                        return;
+                    }
+                    capacidade = n;
+                }
+                uint64_t estado = 0x2545F4914F6CDD1DULL ^ (uint64_t)n;
+                gerarEntradaBench(base, (int)n, (TipoEntrada)e, &algoritmos[a], &estado);
+
+                MetricasOrdenacao m;
+                long long gasto = 0;
+                int rep = 0;
+                while (rep < repeticoes && (rep == 0 || gasto < BENCH_ORCAMENTO_NS)) {
+                    memcpy(copia, base, (size_t)n * sizeof(Componente));
+                    long long t0 = agoraNs();
+                    algoritmos[a].func(copia, (int)n, &m);
+                    amostras[rep] = agoraNs() - t0;
+                    gasto += amostras[rep];
+                    rep++;
+                }
+                qsort(amostras, (size_t)rep, sizeof(long long), compararLongLong);
+                long long mediana = amostras[rep / 2];
+                long long p99 = amostras[(99 * rep + 99) / 100 - 1];
+
+                printf("%-15s %-11s %-9ld %-5d %-12.3f %-12.3f %-12.3f %-13ld %-12ld %-14lld\n",
+                       algoritmos[a].nome, nomesEntrada[e], n, rep, amostras[0] / 1e3,
+                       mediana / 1e3, p99 / 1e3, m.comparacoes, m.trocas, m.bytesMovidos);
+
+                if (medianaAnterior > 0 && mediana > medianaAnterior)
+                    crescimento = (double)mediana / (double)medianaAnterior;
+                if (crescimento < 10.0) crescimento = 10.0;
+                medianaAnterior = mediana > 0 ? mediana : 1;
+            }
+        }
+    }
+
+    free(base);
+    free(copia);
+    free(amostras);
+}
+
+/* ---------- Vetor dinâmico de componentes ---------- */
+
+// Garante espaço para 'necessario' componentes, dobrando a capacidade
+void garantirCapacidade(Componente **arr, int *capacidade, int necessario) {
+    if (necessario <= *capacidade) return;
+    int nova = *capacidade > 0 ? *capacidade : MAX_COMPONENTES;
+    while (nova < necessario) nova *= 2;
+    Componente *novoArr = (Componente*) realloc(*arr, (size_t)nova * sizeof(Componente));
+    if (!novoArr) {
+        fprintf(stderr, "Erro: falha na alocação de memória para componentes.\n");
+        exit(EXIT_FAILURE);
+    }
+    *arr = novoArr;
+    *capacidade = nova;
+}
+
+/* ---------- Importação / exportação CSV ---------- */
+/*
+  Formato: nome,tipo,prioridade (uma linha por componente).
+  A primeira linha pode ser o cabeçalho "nome,tipo,prioridade".
+  Linhas inválidas (campos faltando, nome/tipo vazio ou longo demais,
+  prioridade fora de 1-10) são descartadas e contadas.
+  Os componentes válidos são acumulados em um lote e anexados ao vetor
+  com um único memcpy por lote.
+*/
+int importarComponentesCSV(const char *caminho, Componente **arr, int *total, int *capacidade) {
+    LeitorCSV leitor;
+    if (!abrirLeitorCSV(&leitor, caminho)) {
+        printf("Não foi possível ler o arquivo \"%s\".\n", caminho);
+        return -1;
+    }
+
+    Componente lote[TAM_LOTE_CSV];
+    int noLote = 0, importados = 0, rejeitados = 0;
+    char *campos[3];
+    int n;
+
+    while ((n = proximaLinhaCSV(&leitor, campos, 3)) >= 0) {
+        if (cabecalhoCSV(&leitor, campos, n)) continue;
+
+        int prioridade;
+        if (!validarRegistroCSV(campos, n, NAME_LEN, TYPE_LEN, 1, 10, &prioridade)) {
+            if (rejeitados < 5) printf("Linha %ld inválida, ignorada.\n", leitor.linha);
+            rejeitados++;
+            continue;
+        }
+
+        Componente *c = &lote[noLote++];
+        DEFINIR_CHAVE(c->nome, campos[0]);
+        strcpy(c->tipo, campos[1]);
+        c->prioridade = prioridade;
+
+        if (noLote == TAM_LOTE_CSV) {
+            garantirCapacidade(arr, capacidade, *total + noLote);
+            memcpy(*arr + *total, lote, (size_t)noLote * sizeof(Componente));
+            *total += noLote;
+            importados += noLote;
+            noLote = 0;
+        }
+    }
+    if (noLote > 0) {
+        garantirCapacidade(arr, capacidade, *total + noLote);
+        memcpy(*arr + *total, lote, (size_t)noLote * sizeof(Componente));
+        *total += noLote;
+        importados += noLote;
+    }
+
+    fecharLeitorCSV(&leitor);
+    if (rejeitados > 0) printf("Total de linhas rejeitadas: %d\n", rejeitados);
+    return importados;
+}
+
+// Grava os componentes no mesmo formato aceito pela importação
+int exportarComponentesCSV(const char *caminho, Componente arr[], int n) {
+    EscritorCSV escritor;
+    if (!abrirEscritorCSV(&escritor, caminho)) {
+        printf("Não foi possível criar o arquivo \"%s\".\n", caminho);
+        return 0;
+    }
+    escreverBrutoCSV(&escritor, "nome,tipo,prioridade", '\n');
+    for (int i = 0; i < n; i++) {
+        escreverTextoCSV(&escritor, arr[i].nome.texto, ',');
+        escreverTextoCSV(&escritor, arr[i].tipo, ',');
+        escreverInteiroCSV(&escritor, arr[i].prioridade, '\n');
+    }
+    if (!fecharEscritorCSV(&escritor)) {
+        printf("Erro ao gravar \"%s\".\n", caminho);
+        return 0;
+    }
+    return 1;
+}
+
+/* ---------- Fila de montagem (heap d-ário por prioridade) ---------- */
+/*
+  A montagem consome os componentes do mais urgente (prioridade 1) ao menos
+  urgente; em empate, vale a ordem de cadastro. Cada componente recebe um
+  handle (sua ordem de entrada na fila) e posicao[handle] guarda onde ele
+  está no heap, o que permite diminuir a prioridade em O(log n).
+  A fila guarda a própria cópia de cada componente: é ela que sabe o que
+  ainda está pendente e com qual urgência (o vetor do cadastro é reordenado
+  pelas ordenações). Um índice por nome (endereçamento aberto sobre o hash
+  da chave) leva do nome ao handle sem varrer os componentes.
+  - push / popMin / diminuirPrioridade: O(log n)
+  - handle pelo nome: O(1) esperado
+  - construção a partir de um vetor e reconstrução dos pendentes: O(n)
 */
-typedef void (*SortFunc)(Componente[], int, long *);
+typedef struct {
+    int prioridade;
+    int handle; // também é a ordem de cadastro (desempate)
+} EntradaHeap;
+
+typedef struct {
+    EntradaHeap *heap;
+    int tamanho;
+    int capacidadeHeap;
+    Componente *componentes; // componentes[handle]
+    int *posicao;            // posicao[handle] no heap, -1 se já montado
+    int totalHandles;
+    int capacidadeHandles;
+    int *indiceNomes;        // handles por hash do nome, -1 = vazio
+    int capacidadeIndice;    // potência de 2, pelo menos 2x capacidadeHandles
+} FilaMontagem;
+
+void inicializarFilaMontagem(FilaMontagem *f) {
+    f->heap = NULL;
+    f->tamanho = f->capacidadeHeap = 0;
+    f->componentes = NULL;
+    f->posicao = NULL;
+    f->totalHandles = f->capacidadeHandles = 0;
+    f->indiceNomes = NULL;
+    f->capacidadeIndice = 0;
+}
+
+void liberarFilaMontagem(FilaMontagem *f) {
+    free(f->heap);
+    free(f->componentes);
+    free(f->posicao);
+    free(f->indiceNomes);
+    inicializarFilaMontagem(f);
+}
 
-double medirTempoOrdenacao(SortFunc func, Componente arr[], int n, long *compPtr) {
-    clock_t inicio = clock();
-    func(arr, n, compPtr);
-    clock_t fim = clock();
-    double segundos = ((double)(fim - inicio)) / (double)CLOCKS_PER_SEC;
-    return segundos;
+// Põe o handle no índice por nome (sondagem linear; nomes repetidos coexistem)
+void indexarNomeFilaMontagem(FilaMontagem *f, int h) {
+    int mascara = f->capacidadeIndice - 1;
+    int i = (int)(f->componentes[h].nome.meta.hash & (uint32_t)mascara);
+    while (f->indiceNomes[i] >= 0) i = (i + 1) & mascara;
+    f->indiceNomes[i] = h;
+}
+
+// Refaz o índice por nome com os handles 0..totalHandles-1
+void reindexarNomesFilaMontagem(FilaMontagem *f) {
+    if (f->capacidadeIndice == 0) return;
+    memset(f->indiceNomes, 0xff, (size_t)f->capacidadeIndice * sizeof(int)); // tudo -1
+    for (int h = 0; h < f->totalHandles; h++) indexarNomeFilaMontagem(f, h);
+}
+
+// Garante espaço para 'n' handles e 'n' entradas no heap
+void reservarFilaMontagem(FilaMontagem *f, int n) {
+    if (n <= f->capacidadeHandles) return;
+    int nova = f->capacidadeHandles > 0 ? f->capacidadeHandles : MAX_COMPONENTES;
+    while (nova < n) nova *= 2;
+    EntradaHeap *heap = (EntradaHeap*) realloc(f->heap, (size_t)nova * sizeof(EntradaHeap));
+    Componente *comps = heap ? (Componente*) realloc(f->componentes, (size_t)nova * sizeof(Componente)) : NULL;
+    int *pos = comps ? (int*) realloc(f->posicao, (size_t)nova * sizeof(int)) : NULL;
+    int capIndice = 1;
+    while (capIndice < 2 * nova) capIndice *= 2;
+    int *indice = pos ? (int*) malloc((size_t)capIndice * sizeof(int)) : NULL;
+    if (!heap || !comps || !pos || !indice) {
+        fprintf(stderr, "Erro: falha na alocação da fila de montagem.\n");
+        exit(EXIT_FAILURE);
+    }
+    f->heap = heap;
+    f->componentes = comps;
+    f->posicao = pos;
+    f->capacidadeHeap = f->capacidadeHandles = nova;
+    free(f->indiceNomes);
+    f->indiceNomes = indice;
+    f->capacidadeIndice = capIndice;
+    reindexarNomesFilaMontagem(f);
+}
+
+// a vem antes de b? (menor prioridade; empate pela ordem de cadastro)
+int antesNaFila(EntradaHeap a, EntradaHeap b) {
+    if (a.prioridade != b.prioridade) return a.prioridade < b.prioridade;
+    return a.handle < b.handle;
+}
+
+void subirNoHeap(FilaMontagem *f, int i) {
+    EntradaHeap e = f->heap[i];
+    while (i > 0) {
+        int pai = (i - 1) / ARIDADE_HEAP;
+        if (!antesNaFila(e, f->heap[pai])) break;
+        f->heap[i] = f->heap[pai];
+        f->posicao[f->heap[i].handle] = i;
+        i = pai;
+    }
+    f->heap[i] = e;
+    f->posicao[e.handle] = i;
+}
+
+void descerNoHeap(FilaMontagem *f, int i) {
+    EntradaHeap e = f->heap[i];
+    while (1) {
+        int primeiro = ARIDADE_HEAP * i + 1;
+        if (primeiro >= f->tamanho) break;
+        int ultimo = primeiro + ARIDADE_HEAP;
+        if (ultimo > f->tamanho) ultimo = f->tamanho;
+        int melhor = primeiro;
+        for (int c = primeiro + 1; c < ultimo; c++)
+            if (antesNaFila(f->heap[c], f->heap[melhor])) melhor = c;
+        if (!antesNaFila(f->heap[melhor], e)) break;
+        f->heap[i] = f->heap[melhor];
+        f->posicao[f->heap[i].handle] = i;
+        i = melhor;
+    }
+    f->heap[i] = e;
+    f->posicao[e.handle] = i;
+}
+
+// Insere um componente; retorna o handle dele
+int pushFilaMontagem(FilaMontagem *f, const Componente *c) {
+    reservarFilaMontagem(f, f->totalHandles + 1);
+    int h = f->totalHandles++;
+    f->componentes[h] = *c;
+    indexarNomeFilaMontagem(f, h);
+    f->heap[f->tamanho].prioridade = c->prioridade;
+    f->heap[f->tamanho].handle = h;
+    f->tamanho++;
+    subirNoHeap(f, f->tamanho - 1);
+    return h;
+}
+
+// Próximo componente a montar sem removê-lo (NULL se a fila estiver vazia)
+const Componente* topoFilaMontagem(const FilaMontagem *f) {
+    return f->tamanho > 0 ? &f->componentes[f->heap[0].handle] : NULL;
+}
+
+// Remove o componente mais urgente; retorna 0 se a fila estiver vazia
+int popMinFilaMontagem(FilaMontagem *f, Componente *saida) {
+    if (f->tamanho == 0) return 0;
+    int h = f->heap[0].handle;
+    *saida = f->componentes[h];
+    f->posicao[h] = -1;
+    f->tamanho--;
+    if (f->tamanho > 0) {
+        f->heap[0] = f->heap[f->tamanho];
+        descerNoHeap(f, 0);
+    }
+    return 1;
+}
+
+// Torna um componente pendente mais urgente; retorna 0 se inválido.
+// A prioridade muda no heap e na cópia da fila, que é de onde a reconstrução lê.
+int diminuirPrioridadeFilaMontagem(FilaMontagem *f, int handle, int novaPrioridade) {
+    if (handle < 0 || handle >= f->totalHandles || f->posicao[handle] < 0) return 0;
+    int i = f->posicao[handle];
+    if (novaPrioridade > f->heap[i].prioridade) return 0; // só aumenta a urgência
+    f->heap[i].prioridade = novaPrioridade;
+    f->componentes[handle].prioridade = novaPrioridade;
+    subirNoHeap(f, i);
+    return 1;
+}
+
+// Handle de um componente ainda pendente com esse nome (-1 se não houver)
+int buscarHandleFilaMontagem(const FilaMontagem *f, const char *nome) {
+    if (f->capacidadeIndice == 0) return -1;
+    MetaChave meta;
+    preencherMetaChave(&meta, nome);
+    int mascara = f->capacidadeIndice - 1;
+    for (int i = (int)(meta.hash & (uint32_t)mascara); f->indiceNomes[i] >= 0; i = (i + 1) & mascara) {
+        int h = f->indiceNomes[i];
+        if (f->posicao[h] >= 0 &&
+            chavesIguais(&f->componentes[h].nome.meta, f->componentes[h].nome.texto, &meta, nome))
+            return h;
+    }
+    return -1;
+}
+
+// Monta o heap com os handles 0..n-1 já copiados (heapify bottom-up, O(n))
+void heapificarFilaMontagem(FilaMontagem *f, int n) {
+    for (int i = 0; i < n; i++) {
+        f->heap[i].prioridade = f->componentes[i].prioridade;
+        f->heap[i].handle = i;
+        f->posicao[i] = i;
+    }
+    f->tamanho = f->totalHandles = n;
+    reindexarNomesFilaMontagem(f);
+    for (int i = (n - 2) / ARIDADE_HEAP; i >= 0 && n > 1; i--) descerNoHeap(f, i);
+}
+
+// Recomeça a fila com todos os componentes do vetor
+void construirFilaMontagem(FilaMontagem *f, Componente arr[], int n) {
+    f->tamanho = 0;
+    f->totalHandles = 0;
+    reservarFilaMontagem(f, n);
+    if (n > 0) memcpy(f->componentes, arr, (size_t)n * sizeof(Componente));
+    heapificarFilaMontagem(f, n);
+}
+
+// Refaz o heap só com os pendentes, em ordem de cadastro: mantém as urgências
+// alteradas, deixa de fora o que já foi montado e compacta os handles
+void reconstruirFilaMontagem(FilaMontagem *f) {
+    int n = 0;
+    for (int h = 0; h < f->totalHandles; h++)
+        if (f->posicao[h] >= 0) f->componentes[n++] = f->componentes[h];
+    heapificarFilaMontagem(f, n);
 }
 
 /* ---------- Menu e fluxo principal ---------- */
 
 int main() {
-    Componente componentes[MAX_COMPONENTES];
+    int capacidade = MAX_COMPONENTES;
+    Componente *componentes = (Componente*) malloc((size_t)capacidade * sizeof(Componente));
     int total = 0;
     int opcao;
     int ordenadoPorNome = 0; // flag para indicar se vetor está ordenado por nome
+    IndiceEytzinger indice = {NULL, NULL, 0}; // montado sob demanda enquanto ordenado por nome
+    FilaMontagem filaMontagem;               // componentes pendentes, do mais urgente ao menos
+    inicializarFilaMontagem(&filaMontagem);
+
+    if (!componentes) {
+        fprintf(stderr, "Erro: falha na alocação de memória para componentes.\n");
+        return EXIT_FAILURE;
+    }
 
     printf("=== MONTAGEM DA TORRE DE RESGATE - MÓDULO AVANÇADO ===\n");
 
@@ -196,6 +887,14 @@ int main() {
         printf("5 - Ordenar com Selection Sort (por PRIORIDADE)\n");
         printf("6 - Buscar componente-chave (BUSCA BINÁRIA por NOME) [requer ordenação por nome]\n");
         printf("7 - Zerar cadastro (remover todos)\n");
+        printf("8 - Benchmark de busca (BINÁRIA x EYTZINGER)\n");
+        printf("9 - Benchmark de ordenação (repetições, min/mediana/p99, varredura de n)\n");
+        printf("10 - Importar componentes de CSV (nome,tipo,prioridade)\n");
+        printf("11 - Exportar componentes para CSV\n");
+        printf("12 - Ver próximo componente a montar (fila de prioridade)\n");
+        printf("13 - Montar próximo componente (remove o mais urgente)\n");
+        printf("14 - Aumentar urgência de um componente pendente\n");
+        printf("15 - Reconstruir fila de montagem (componentes pendentes)\n");
         printf("0 - Sair\n");
         opcao = ler_inteiro("Escolha uma opção: ");
 
@@ -205,12 +904,10 @@ int main() {
         }
 
         if (opcao == 1) {
-            if (total >= MAX_COMPONENTES) {
-                printf("Capacidade máxima (%d) atingida.\n", MAX_COMPONENTES);
-                continue;
-            }
             Componente c;
-            ler_string(c.nome, NAME_LEN, "Digite o NOME do componente: ");
+            char nome[NAME_LEN];
+            ler_string(nome, NAME_LEN, "Digite o NOME do componente: ");
+            DEFINIR_CHAVE(c.nome, nome);
             ler_string(c.tipo, TYPE_LEN, "Digite o TIPO do componente: ");
             int p;
             while (1) {
@@ -219,8 +916,11 @@ int main() {
                 printf("Prioridade inválida. Informe entre 1 e 10.\n");
             }
             c.prioridade = p;
+            garantirCapacidade(&componentes, &capacidade, total + 1);
             componentes[total++] = c;
+            pushFilaMontagem(&filaMontagem, &c);
             ordenadoPorNome = 0; // inserção quebra a ordenação por nome
+            liberarIndiceEytzinger(&indice);
             printf("Componente cadastrado com sucesso.\n");
             mostrarComponentes(componentes, total);
         }
@@ -233,10 +933,12 @@ int main() {
                 continue;
             }
             // vamos copiar o vetor para preservar possível comparação? não necessário; operamos diretamente.
-            long comparacoes = 0;
-            double tempo = medirTempoOrdenacao(bubbleSortNome, componentes, total, &comparacoes);
+            MetricasOrdenacao m;
+            double tempo = medirTempoOrdenacao(bubbleSortNome, componentes, total, &m);
             ordenadoPorNome = 1;
-            printf("\nBubble Sort concluído (por NOME).\nComparações: %ld\nTempo: %.6f segundos\n", comparacoes, tempo);
+            liberarIndiceEytzinger(&indice); // posições podem ter mudado
+            printf("\nBubble Sort concluído (por NOME).\nComparações: %ld\nTrocas: %ld\nBytes movidos: %lld\nTempo: %.9f segundos\n",
+                   m.comparacoes, m.trocas, m.bytesMovidos, tempo);
             mostrarComponentes(componentes, total);
         }
         else if (opcao == 4) { // Insertion Sort por tipo
@@ -244,10 +946,12 @@ int main() {
                 printf("Nenhum componente para ordenar.\n");
                 continue;
             }
-            long comparacoes = 0;
-            double tempo = medirTempoOrdenacao(insertionSortTipo, componentes, total, &comparacoes);
+            MetricasOrdenacao m;
+            double tempo = medirTempoOrdenacao(insertionSortTipo, componentes, total, &m);
             ordenadoPorNome = 0; // ordenação por tipo quebra ordenação por nome
-            printf("\nInsertion Sort concluído (por TIPO).\nComparações: %ld\nTempo: %.6f segundos\n", comparacoes, tempo);
+            liberarIndiceEytzinger(&indice);
+            printf("\nInsertion Sort concluído (por TIPO).\nComparações: %ld\nTrocas: %ld\nBytes movidos: %lld\nTempo: %.9f segundos\n",
+                   m.comparacoes, m.trocas, m.bytesMovidos, tempo);
             mostrarComponentes(componentes, total);
         }
         else if (opcao == 5) { // Selection Sort por prioridade
@@ -255,10 +959,12 @@ int main() {
                 printf("Nenhum componente para ordenar.\n");
                 continue;
             }
-            long comparacoes = 0;
-            double tempo = medirTempoOrdenacao(selectionSortPrioridade, componentes, total, &comparacoes);
+            MetricasOrdenacao m;
+            double tempo = medirTempoOrdenacao(selectionSortPrioridade, componentes, total, &m);
             ordenadoPorNome = 0; // ordenação por prioridade quebra ordenação por nome
-            printf("\nSelection Sort concluído (por PRIORIDADE).\nComparações: %ld\nTempo: %.6f segundos\n", comparacoes, tempo);
+            liberarIndiceEytzinger(&indice);
+            printf("\nSelection Sort concluído (por PRIORIDADE).\nComparações: %ld\nTrocas: %ld\nBytes movidos: %lld\nTempo: %.9f segundos\n",
+                   m.comparacoes, m.trocas, m.bytesMovidos, tempo);
             mostrarComponentes(componentes, total);
         }
         else if (opcao == 6) {
@@ -273,28 +979,118 @@ int main() {
             char chave[NAME_LEN];
             ler_string(chave, NAME_LEN, "Digite o NOME do componente-chave a buscar: ");
             long comparacoes = 0;
-            clock_t t0 = clock();
+            long long t0 = agoraNs();
             int pos = buscaBinariaPorNome(componentes, total, chave, &comparacoes);
-            clock_t t1 = clock();
-            double tempo = ((double)(t1 - t0)) / CLOCKS_PER_SEC;
+            long long t1 = agoraNs();
+            double tempo = (double)(t1 - t0) / 1e9;
             if (pos >= 0) {
                 printf("\nComponente encontrado na posição %d (índice %d).\n", pos+1, pos);
                 printf("Nome: %s | Tipo: %s | Prioridade: %d\n",
-                       componentes[pos].nome, componentes[pos].tipo, componentes[pos].prioridade);
+                       componentes[pos].nome.texto, componentes[pos].tipo, componentes[pos].prioridade);
             } else {
                 printf("\nComponente NÃO encontrado.\n");
             }
-            printf("Comparações na busca binária: %ld\nTempo da busca: %.6f segundos\n", comparacoes, tempo);
+            printf("Comparações na busca binária: %ld\nTempo da busca: %.9f segundos\n", comparacoes, tempo);
+
+            // mesma busca pelo índice Eytzinger (montado na primeira busca após a ordenação)
+            if (indice.prefixos == NULL) construirIndiceEytzinger(&indice, componentes, total);
+            long compEytzinger = 0;
+            long long e0 = agoraNs();
+            int posEytzinger = buscaEytzingerPorNome(&indice, componentes, chave, &compEytzinger);
+            long long e1 = agoraNs();
+            printf("Comparações no índice Eytzinger: %ld (posição %d)\nTempo da busca: %lld ns\n",
+                   compEytzinger, posEytzinger >= 0 ? posEytzinger + 1 : -1, e1 - e0);
         }
         else if (opcao == 7) {
             total = 0;
             ordenadoPorNome = 0;
+            liberarIndiceEytzinger(&indice);
+            construirFilaMontagem(&filaMontagem, componentes, 0);
             printf("Cadastro zerado.\n");
         }
+        else if (opcao == 8) {
+            int n = ler_inteiro("Quantidade de componentes sintéticos (ex: 1000000): ");
+            int consultas = ler_inteiro("Quantidade de buscas (ex: 1000000): ");
+            benchmarkBuscas(n, consultas);
+        }
+        else if (opcao == 9) {
+            int repeticoes = ler_inteiro("Repetições por medição (ex: 31): ");
+            int nMax = ler_inteiro("N máximo da varredura (10 a 10000000): ");
+            benchmarkOrdenacao(repeticoes, nMax);
+        }
+        else if (opcao == 10) {
+            char caminho[256];
+            ler_string(caminho, sizeof(caminho), "Caminho do arquivo CSV: ");
+            int totalAntes = total;
+            long long t0 = agoraNs();
+            int importados = importarComponentesCSV(caminho, &componentes, &total, &capacidade);
+            long long t1 = agoraNs();
+            if (importados >= 0) {
+                for (int i = totalAntes; i < total; i++) pushFilaMontagem(&filaMontagem, &componentes[i]);
+                if (importados > 0) {
+                    ordenadoPorNome = 0; // novos componentes quebram a ordenação por nome
+                    liberarIndiceEytzinger(&indice);
+                }
+                printf("%d componentes importados em %.3f ms (%.0f linhas/s). Total: %d\n",
+                       importados, (t1 - t0) / 1e6,
+                       t1 > t0 ? importados / ((t1 - t0) / 1e9) : 0.0, total);
+            }
+        }
+        else if (opcao == 11) {
+            char caminho[256];
+            ler_string(caminho, sizeof(caminho), "Caminho do arquivo CSV de saída: ");
+            long long t0 = agoraNs();
+            if (exportarComponentesCSV(caminho, componentes, total)) {
+                long long t1 = agoraNs();
+                printf("%d componentes exportados em %.3f ms.\n", total, (t1 - t0) / 1e6);
+            }
+        }
+        else if (opcao == 12) {
+            const Componente *prox = topoFilaMontagem(&filaMontagem);
+            if (!prox) {
+                printf("Nenhum componente pendente de montagem.\n");
+                continue;
+            }
+            printf("Próximo a montar: %s | Tipo: %s | Prioridade: %d (%d pendentes)\n",
+                   prox->nome.texto, prox->tipo, prox->prioridade, filaMontagem.tamanho);
+        }
+        else if (opcao == 13) {
+            Componente montado;
+            if (!popMinFilaMontagem(&filaMontagem, &montado)) {
+                printf("Nenhum componente pendente de montagem.\n");
+                continue;
+            }
+            printf("Componente montado: %s | Tipo: %s | Prioridade: %d (%d pendentes)\n",
+                   montado.nome.texto, montado.tipo, montado.prioridade, filaMontagem.tamanho);
+        }
+        else if (opcao == 14) {
+            char nome[NAME_LEN];
+            ler_string(nome, NAME_LEN, "NOME do componente pendente: ");
+            int h = buscarHandleFilaMontagem(&filaMontagem, nome);
+            if (h < 0) {
+                printf("Componente não está pendente de montagem.\n");
+                continue;
+            }
+            int p = ler_inteiro("Nova PRIORIDADE (menor que a atual, mínimo 1): ");
+            if (p < 1 || !diminuirPrioridadeFilaMontagem(&filaMontagem, h, p))
+                printf("Prioridade inválida: só é possível aumentar a urgência.\n");
+            else
+                printf("Prioridade de \"%s\" atualizada para %d.\n", nome, p);
+        }
+        else if (opcao == 15) {
+            long long t0 = agoraNs();
+            reconstruirFilaMontagem(&filaMontagem);
+            long long t1 = agoraNs();
+            printf("Fila de montagem reconstruída com %d componentes pendentes em %.3f ms.\n",
+                   filaMontagem.tamanho, (t1 - t0) / 1e6);
+        }
         else {
             printf("Opção inválida. Tente novamente.\n");
         }
     }
 
+    liberarIndiceEytzinger(&indice);
+    liberarFilaMontagem(&filaMontagem);
+    free(componentes);
     return 0;
 }
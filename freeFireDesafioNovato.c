@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include "csvRapido.h"
 
 #define MAX_ITENS 10
 
@@ -106,6 +107,73 @@ void removerItem() {
     listarItens();
 }
 
+// -----------------------------
+// FUNÇÃO: IMPORTAR ITENS DE CSV
+// -----------------------------
+// Formato: nome,tipo,quantidade (cabeçalho opcional na primeira linha).
+// Linhas inválidas são ignoradas; o que não couber na mochila é descartado.
+void importarItensCSV() {
+    char caminho[256];
+    printf("\nDigite o caminho do arquivo CSV: ");
+    scanf("%255s", caminho);
+
+    LeitorCSV leitor;
+    if (!abrirLeitorCSV(&leitor, caminho)) {
+        printf("\nNao foi possivel ler o arquivo.\n");
+        return;
+    }
+
+    int importados = 0, rejeitados = 0, semEspaco = 0;
+    char *campos[3];
+    int n;
+    while ((n = proximaLinhaCSV(&leitor, campos, 3)) >= 0) {
+        if (cabecalhoCSV(&leitor, campos, n)) continue;
+
+        int quantidade;
+        if (!validarRegistroCSV(campos, n, sizeof(mochila[0].nome), sizeof(mochila[0].tipo),
+                                1, INT_MAX, &quantidade)) {
+            rejeitados++;
+            continue;
+        }
+        if (totalItens >= MAX_ITENS) {
+            semEspaco++;
+            continue;
+        }
+        strcpy(mochila[totalItens].nome, campos[0]);
+        strcpy(mochila[totalItens].tipo, campos[1]);
+        mochila[totalItens].quantidade = quantidade;
+        totalItens++;
+        importados++;
+    }
+    fecharLeitorCSV(&leitor);
+
+    printf("\nItens importados: %d | Linhas invalidas: %d | Sem espaco na mochila: %d\n",
+           importados, rejeitados, semEspaco);
+}
+
+// -----------------------------
+// FUNÇÃO: EXPORTAR ITENS PARA CSV
+// -----------------------------
+void exportarItensCSV() {
+    char caminho[256];
+    printf("\nDigite o caminho do arquivo CSV de saida: ");
+    scanf("%255s", caminho);
+
+    EscritorCSV escritor;
+    if (!abrirEscritorCSV(&escritor, caminho)) {
+        printf("\nNao foi possivel criar o arquivo.\n");
+        return;
+    }
+    escreverBrutoCSV(&escritor, "nome,tipo,quantidade", '\n');
+    for (int i = 0; i < totalItens; i++) {
+        escreverTextoCSV(&escritor, mochila[i].nome, ',');
+        escreverTextoCSV(&escritor, mochila[i].tipo, ',');
+        escreverInteiroCSV(&escritor, mochila[i].quantidade, '\n');
+    }
+    if (fecharEscritorCSV(&escritor)) printf("\n%d itens exportados.\n", totalItens);
+    else printf("\nErro ao gravar o arquivo.\n");
+}
+
 // -----------------------------
 // FUNÇÃO PRINCIPAL (MENU)
 // -----------------------------
@@ -120,6 +188,8 @@ int main() {
         printf("2 - Remover item\n");
         printf("3 - Listar itens\n");
         printf("4 - Buscar item\n");
+        printf("5 - Importar itens de CSV\n");
+        printf("6 - Exportar itens para CSV\n");
         printf("0 - Sair\n");
         printf("Escolha uma opcao: ");
         scanf("%d", &opcao);
@@ -151,6 +221,12 @@ int main() {
                 }
                 break;
             }
+            case 5:
+                importarItensCSV();
+                break;
+            case 6:
+                exportarItensCSV();
+                break;
             case 0:
                 printf("\nEncerrando o sistema...\n");
                 break;
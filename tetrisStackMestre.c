@@ -1,98 +1,512 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>   // compilar com -pthread
+#include <stdatomic.h>
+#include <stdint.h>
+#include <unistd.h>    // sysconf
 
-#define TAM_FILA 5
+#define TAM_FILA 5    // capacidade padrao (e do buffer interno, sem alocacao)
 #define TAM_PILHA 3
+#define TROCA_PADRAO 3 // k usado pelo bot em trocaMultipla
+
+// Com -DFILA_PILHA_FIXAS a capacidade vira constante de compilacao
+// (TAM_FILA/TAM_PILHA), sem crescimento: o caminho rapido original.
+// O anel fixo tem TAM_PILHA posicoes de folga alem das TAM_FILA de jogo:
+// a fila so e completada ate ALVO_FILA, e a folga recebe as pecas que
+// voltam da reserva (devolver nunca encontra a fila cheia).
+#ifdef FILA_PILHA_FIXAS
+#define LOCAL_FILA (TAM_FILA + TAM_PILHA)
+#define CAP_FILA(f) LOCAL_FILA
+#define ALVO_FILA(f) TAM_FILA
+#define CAP_PILHA(p) TAM_PILHA
+#else
+#define LOCAL_FILA TAM_FILA
+#define CAP_FILA(f) ((f)->capacidade)
+#define ALVO_FILA(f) ((f)->capacidade)
+#define CAP_PILHA(p) ((p)->capacidade)
+#endif
+
+#define LINHA_CACHE 64
+#define BENCH_ANEL_CAPACIDADE 1024   // potencia de 2
+#define BENCH_ANEL_PECAS 20000000
+#define BENCH_ANEL_LOTE 64
 
 // ------------------------------------------------------------
 // Estrutura da peça
 // ------------------------------------------------------------
+// 4 bytes: tipo nos 3 bits baixos (indice em TIPOS_PECA), id nos 29 de cima.
+// Use criarPeca/tipoPeca/nomePeca/idPeca em vez de mexer nos bits.
+#define TOTAL_TIPOS 7
+#define BITS_TIPO 3
+#define MASCARA_ID ((1u << (32 - BITS_TIPO)) - 1) // ids voltam a 0 depois disso
+
+static const char TIPOS_PECA[TOTAL_TIPOS] = {'I', 'O', 'T', 'S', 'Z', 'J', 'L'};
+
 typedef struct {
-    char nome; // 'I', 'O', 'T', 'L'
-    int id;
+    uint32_t codigo;
 } Peca;
 
+_Static_assert(sizeof(Peca) == 4, "Peca deve ocupar 4 bytes");
+
+static inline Peca criarPeca(int tipo, uint32_t id) {
+    Peca p = {((id & MASCARA_ID) << BITS_TIPO) | (uint32_t)tipo};
+    return p;
+}
+static inline int tipoPeca(Peca p) { return (int)(p.codigo & ((1u << BITS_TIPO) - 1)); }
+static inline char nomePeca(Peca p) { return TIPOS_PECA[tipoPeca(p)]; }
+static inline int idPeca(Peca p) { return (int)(p.codigo >> BITS_TIPO); }
+
+// ------------------------------------------------------------
+// Sorteio de pecas: gerador pequeno com semente + estrategia trocavel
+// ------------------------------------------------------------
+#define HISTORICO_TENTATIVAS 4 // sorteios antes de aceitar uma das 4 ultimas (estilo TGM)
+#define BENCH_SORTEIO_PECAS 50000000
+#define BENCH_SORTEIO_LOTE 1024
+
+typedef enum { SORTEIO_PURO, SORTEIO_SACO, SORTEIO_HISTORICO } TipoSorteio;
+
+// Cada jogo/thread tem o seu: nada de estado global como em rand()
+typedef struct Sorteador {
+    uint64_t estado;                          // xorshift64*
+    int (*proximoTipo)(struct Sorteador *s);  // estrategia (indice em TIPOS_PECA)
+    uint8_t saco[TOTAL_TIPOS];
+    int restantesSaco;
+    uint32_t historico;                       // 4 ultimos tipos, 1 byte cada
+    int primeira;
+    uint32_t proximoId;
+} Sorteador;
+
+// ------------------------------------------------------------
+// Tabuleiro em bitboard: cada linha e um uint16_t (10 bits usados)
+// ------------------------------------------------------------
+#define LARGURA_TABULEIRO 10
+#define ALTURA_VISIVEL 20
+#define ALTURA_TABULEIRO 24 // 4 linhas acima da area visivel para o nascimento
+#define LINHA_CHEIA 0x3FF
+#define BENCH_TABULEIRO_JOGADAS 50000000
+#define BENCH_TABULEIRO_ROTEIRO 4096
+#define FIM_DE_JOGO -2
+#define POSICAO_INVALIDA -1
+
+// Uma rotacao ja normalizada: linhas[0] e a de baixo, bit 0 e a coluna 0
+typedef struct {
+    uint16_t linhas[4];
+    uint8_t largura;
+    uint8_t altura;
+} FormaPeca;
+
+typedef struct {
+    // 4 linhas extras sempre vazias: a peca pode ser testada acima do topo
+    // sem checagem de limite
+    uint16_t linhas[ALTURA_TABULEIRO + 4];
+    int altura;          // linha ocupada mais alta + 1
+    int celulas;         // celulas ocupadas (usado pela heuristica do bot)
+    long pecasColocadas;
+    long linhasLimpas;
+} Tabuleiro;
+
+typedef struct {
+    int rotacao;
+    int coluna;
+} Jogada;
+
+// ------------------------------------------------------------
+// Registro de eventos: fluxo so de acrescimo, compactado em bits
+// ------------------------------------------------------------
+/*
+  Cada evento comeca com 3 bits de codigo:
+    GERADA          tipo (3) + 1 bit "id = anterior + 1" [+ id (29) se nao]
+    JOGADA / USADA  rotacao (2) + coluna (4)   (frente da fila / topo da pilha)
+    RESERVADA, TROCA_TOPO, DEVOLVIDA           (so o codigo)
+    TROCA_MULTIPLA  tamanho de k em bits (5) + k
+  O codigo 0 marca o fim; depois dele o ultimo byte e completado com zeros
+  e vem o rodape: "FIM1" + total de eventos (64 bits, little-endian). Sem o
+  rodape o registro foi truncado e a reproducao o recusa.
+  Os bits sao acumulados em 64 bits, passam ao bloco de 4 em 4 bytes e o
+  bloco vai para o arquivo inteiro de uma vez.
+*/
+#define REGISTRO_BLOCO (1 << 16)
+#define REGISTRO_ASSINATURA "TTR1"
+#define REGISTRO_RODAPE "FIM1"
+#define BENCH_REGISTRO_EVENTOS 20000000
+
+typedef enum {
+    EVENTO_FIM, EVENTO_GERADA, EVENTO_JOGADA, EVENTO_RESERVADA,
+    EVENTO_USADA, EVENTO_TROCA_TOPO, EVENTO_TROCA_MULTIPLA, EVENTO_DEVOLVIDA
+} TipoEvento;
+
+typedef struct {
+    FILE *arquivo;
+    uint8_t *bloco;
+    size_t usado;         // bytes completos no bloco
+    uint64_t acumulador;  // bits ainda fora do bloco (menos de 32)
+    int bits;
+    uint32_t ultimoId;
+    long eventos;
+    int erro;
+} RegistroEventos;
+
+void descarregarRegistro(RegistroEventos *r);
+
+// n <= 32 bits por chamada
+static inline void escreverBits(RegistroEventos *r, uint32_t valor, int n) {
+    r->acumulador |= (uint64_t)valor << r->bits;
+    r->bits += n;
+    if (r->bits >= 32) {
+        uint8_t *b = r->bloco + r->usado;
+        b[0] = (uint8_t)r->acumulador;
+        b[1] = (uint8_t)(r->acumulador >> 8);
+        b[2] = (uint8_t)(r->acumulador >> 16);
+        b[3] = (uint8_t)(r->acumulador >> 24);
+        r->usado += 4;
+        r->acumulador >>= 32;
+        r->bits -= 32;
+        if (r->usado == REGISTRO_BLOCO) descarregarRegistro(r);
+    }
+}
+
+// Todas aceitam r == NULL (sem registro), para nao poluir quem chama
+static inline void registrarGerada(RegistroEventos *r, Peca p) {
+    if (!r) return;
+    uint32_t id = (uint32_t)idPeca(p);
+    if (id == ((r->ultimoId + 1) & MASCARA_ID)) {
+        escreverBits(r, EVENTO_GERADA | (uint32_t)tipoPeca(p) << 3 | 1u << 6, 7);
+    } else {
+        escreverBits(r, EVENTO_GERADA | (uint32_t)tipoPeca(p) << 3, 7);
+        escreverBits(r, id, 32 - BITS_TIPO);
+    }
+    r->ultimoId = id;
+    r->eventos++;
+}
+
+static inline void registrarEvento(RegistroEventos *r, TipoEvento e) {
+    if (!r) return;
+    escreverBits(r, e, 3);
+    r->eventos++;
+}
+
+static inline void registrarJogada(RegistroEventos *r, TipoEvento e, Jogada j) {
+    if (!r) return;
+    escreverBits(r, e | (uint32_t)(j.rotacao & 3) << 3 | (uint32_t)j.coluna << 5, 9);
+    r->eventos++;
+}
+
+static inline void registrarTrocaMultipla(RegistroEventos *r, int k) {
+    if (!r) return;
+    int n = 32 - __builtin_clz((unsigned)k);
+    escreverBits(r, EVENTO_TROCA_MULTIPLA | (uint32_t)n << 3, 8);
+    escreverBits(r, (uint32_t)k, n);
+    r->eventos++;
+}
+
+// ------------------------------------------------------------
+// Simulacao sem interface: bot que escolhe jogadas por heuristica
+// ------------------------------------------------------------
+// Pesos da heuristica de quatro termos de Yiyuan Lee (soma das alturas,
+// linhas, buracos e irregularidade)
+#define PESO_ALTURAS -0.510066
+#define PESO_LINHAS 0.760666
+#define PESO_BURACOS -0.35663
+#define PESO_IRREGULAR -0.184483
+#define NOTA_DERROTA -1e9
+#define SIM_PECAS_PADRAO 2000
+#define MAX_THREADS_SIM 256
+
+typedef enum { ACAO_JOGAR, ACAO_TROCAR_TOPO, ACAO_TROCA_MULTIPLA, ACAO_RESERVAR, TOTAL_ACOES } AcaoBot;
+
+typedef struct {
+    long pecas;
+    long linhas;
+    long acoes[TOTAL_ACOES];
+    int derrota; // 0 se parou pelo limite de pecas
+} ResultadoPartida;
+
+typedef struct {
+    int jogos;
+    long pecasMax;       // limite por partida
+    int capFila, capPilha;
+    TipoSorteio sorteio;
+    uint64_t semente;    // partida j usa semente + j
+    int previsao;        // 1 = tambem avalia a peca seguinte
+    const char *registro; // se nao for NULL, partida j grava em "<registro>.j"
+    atomic_int proximoJogo;
+    ResultadoPartida *resultados;
+} Simulacao;
+
+// ------------------------------------------------------------
+// Renderizacao em lote: o quadro inteiro em um buffer, um fwrite
 // ------------------------------------------------------------
-// Fila circular
+#define RENDER_FIXO 4096   // cabecalho, tabuleiro, titulos e menu
+#define RENDER_POR_PECA 14 // "[X 536870911] "
+
+typedef struct {
+    char *buffer;
+    size_t capacidade;
+    size_t usado;
+    int silencioso;      // 1 = nao desenha nada (menus roteirizados, lote)
+    long quadros;
+    long long nsTotal;   // tempo montando e escrevendo os quadros
+} Renderizador;
+
 // ------------------------------------------------------------
+// Fila circular (deque: insere/remove nas duas pontas)
+// ------------------------------------------------------------
+// 'itens' aponta para 'local' ate a capacidade passar de TAM_FILA; so
+// entao a fila usa o heap. Por isso a Fila nao deve ser copiada por valor.
 typedef struct {
-    Peca itens[TAM_FILA];
+    Peca *itens;
+    int capacidade;
     int inicio;
     int fim;
     int quantidade;
+    int crescer;            // 1 = dobra a capacidade quando cheia
+    Peca local[LOCAL_FILA];
 } Fila;
 
 // ------------------------------------------------------------
 // Pilha
 // ------------------------------------------------------------
 typedef struct {
-    Peca itens[TAM_PILHA];
+    Peca *itens;            // 'local' ou heap, como na fila
+    int capacidade;
     int topo;
+    int crescer;
+    Peca local[TAM_PILHA];
 } Pilha;
 
 // ------------------------------------------------------------
-int contadorID = 0;
+// Anel SPSC sem travas (um produtor, um consumidor)
+// ------------------------------------------------------------
+// cabeca e cauda ficam em linhas de cache separadas: o produtor so escreve
+// a cauda e o consumidor so escreve a cabeca. Cada lado guarda uma copia
+// do indice do outro e so rele o atomico quando a copia indica cheio/vazio.
+typedef struct {
+    _Alignas(LINHA_CACHE) atomic_size_t cauda;   // proxima posicao a escrever (produtor)
+    size_t cabecaVista;                          // ultima cabeca lida pelo produtor
+    _Alignas(LINHA_CACHE) atomic_size_t cabeca;  // proxima posicao a ler (consumidor)
+    size_t caudaVista;                           // ultima cauda lida pelo consumidor
+    _Alignas(LINHA_CACHE) Peca *itens;
+    size_t mascara;                              // capacidade - 1 (capacidade potencia de 2)
+} AnelSPSC;
+
+// ------------------------------------------------------------
+Sorteador sorteadorJogo; // usado por gerarPeca()
+FormaPeca formas[TOTAL_TIPOS][4]; // preenchida por prepararFormas()
 
 // Prototipos
 void inicializarFila(Fila *f);
 void inicializarPilha(Pilha *p);
+int inicializarFilaCapacidade(Fila *f, int capacidade, int crescer);
+int inicializarPilhaCapacidade(Pilha *p, int capacidade, int crescer);
+void liberarFila(Fila *f);
+void liberarPilha(Pilha *p);
 int filaVazia(Fila *f);
 int filaCheia(Fila *f);
 int pilhaVazia(Pilha *p);
 int pilhaCheia(Pilha *p);
+int posicaoFila(Fila *f, int i);
+Peca pecaNaFila(Fila *f, int i);
 
+void inicializarSorteador(Sorteador *s, TipoSorteio tipo, uint64_t semente);
+Peca proximaPeca(Sorteador *s);
+void gerarLotePecas(Sorteador *s, Peca *destino, int n);
+int completarFila(Fila *f, Sorteador *s);
+void benchmarkSorteio(void);
 Peca gerarPeca();
-void enqueue(Fila *f, Peca p);
+
+void prepararFormas(void);
+void limparTabuleiro(Tabuleiro *t);
+int colocarPeca(Tabuleiro *t, int tipo, int rotacao, int coluna);
+int jogarNoTabuleiro(Tabuleiro *t, Peca p, Jogada *feita);
+void benchmarkTabuleiro(void);
+
+double avaliarTabuleiro(const Tabuleiro *t);
+double buscarJogada(const Tabuleiro *t, const int *tipos, int n, Jogada *melhor);
+int jogarPartida(Simulacao *sim, int jogo, ResultadoPartida *r);
+int simular(Simulacao *sim, int threads);
+
+int iniciarRegistro(RegistroEventos *r, FILE *arquivo);
+int finalizarRegistro(RegistroEventos *r);
+void reporPeca(Fila *f, RegistroEventos *r);
+long reproduzirRegistro(FILE *arquivo, long ate, Fila *f, Pilha *p, Tabuleiro *t);
+void benchmarkRegistro(void);
+int enqueue(Fila *f, Peca p);
 Peca dequeue(Fila *f);
+int enqueueFrente(Fila *f, Peca p);
+Peca dequeueFim(Fila *f);
 
-void push(Pilha *p, Peca x);
+int push(Pilha *p, Peca x);
 Peca pop(Pilha *p);
 
-void trocarTopo(Fila *f, Pilha *p);
-void trocaMultipla(Fila *f, Pilha *p);
+int trocarTopo(Fila *f, Pilha *p);
+int trocaMultipla(Fila *f, Pilha *p, int k);
+void descartarLinha(void);
+
+void inicializarRenderizador(Renderizador *r, int pecas, int silencioso);
+void liberarRenderizador(Renderizador *r);
+void exibirEstado(Renderizador *r, Fila *f, Pilha *p, Tabuleiro *t, const char *rodape);
 
-void exibirEstado(Fila *f, Pilha *p);
+int inicializarAnel(AnelSPSC *a, size_t capacidade);
+void liberarAnel(AnelSPSC *a);
+int enqueueAnel(AnelSPSC *a, Peca p);
+int dequeueAnel(AnelSPSC *a, Peca *p);
+size_t enqueueLoteAnel(AnelSPSC *a, const Peca *pecas, size_t n);
+size_t dequeueLoteAnel(AnelSPSC *a, Peca *pecas, size_t max);
+void benchmarkAnel(void);
+long long agoraNs(void);
 
 // ------------------------------------------------------------
 // MAIN
 // ------------------------------------------------------------
-int main() {
+// Uso: tetrisStackMestre [capacidade_fila [capacidade_pilha]]
+//                         [--semente N] [--sorteio puro|saco|historico]
+//                         [--simular JOGOS [--threads N] [--pecas MAX] [--previsao 0|1]]
+//                         [--registro ARQ] [--reproduzir ARQ [--ate EVENTO]]
+//                         [--silencioso]
+int main(int argc, char *argv[]) {
     Fila fila;
     Pilha pilha;
+    Tabuleiro tabuleiro;
+    Renderizador tela;
+    int silencioso = 0;
+    RegistroEventos registro, *reg = NULL;
+    FILE *arquivoRegistro = NULL;
+    const char *caminhoRegistro = NULL, *caminhoReproduzir = NULL;
+    long ate = -1;
 
-    inicializarFila(&fila);
-    inicializarPilha(&pilha);
+    int capFila = TAM_FILA, capPilha = TAM_PILHA, posicional = 0;
+    uint64_t semente = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 32);
+    TipoSorteio tipo = SORTEIO_SACO;
+    int jogos = 0, threads = (int)sysconf(_SC_NPROCESSORS_ONLN), previsao = 1;
+    long pecasMax = SIM_PECAS_PADRAO;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--simular") == 0 && i + 1 < argc) {
+            jogos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pecas") == 0 && i + 1 < argc) {
+            pecasMax = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--previsao") == 0 && i + 1 < argc) {
+            previsao = atoi(argv[++i]) != 0;
+        } else if (strcmp(argv[i], "--silencioso") == 0) {
+            silencioso = 1;
+        } else if (strcmp(argv[i], "--registro") == 0 && i + 1 < argc) {
+            caminhoRegistro = argv[++i];
+        } else if (strcmp(argv[i], "--reproduzir") == 0 && i + 1 < argc) {
+            caminhoReproduzir = argv[++i];
+        } else if (strcmp(argv[i], "--ate") == 0 && i + 1 < argc) {
+            ate = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--sorteio") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "puro") == 0) tipo = SORTEIO_PURO;
+            else if (strcmp(argv[i], "saco") == 0) tipo = SORTEIO_SACO;
+            else if (strcmp(argv[i], "historico") == 0) tipo = SORTEIO_HISTORICO;
+            else { printf("Sorteio desconhecido: %s\n", argv[i]); return 1; }
+        } else if (posicional == 0) {
+            capFila = atoi(argv[i]);
+            posicional++;
+        } else {
+            capPilha = atoi(argv[i]);
+        }
+    }
+    // A fila pode crescer alem de capFila quando uma peca volta da reserva
+    // para a frente; so e reposta enquanto estiver abaixo de capFila
+    if (!inicializarFilaCapacidade(&fila, capFila, 1) || !inicializarPilhaCapacidade(&pilha, capPilha, 0)) {
+        printf("Capacidades invalidas ou sem memoria.\n");
+        return 1;
+    }
+    inicializarSorteador(&sorteadorJogo, tipo, semente);
+    prepararFormas();
+    limparTabuleiro(&tabuleiro);
+    printf("Semente: %llu\n", (unsigned long long)semente);
 
-    // Preenche a fila inicialmente
-    for (int i = 0; i < TAM_FILA; i++)
-        enqueue(&fila, gerarPeca());
+    // Modo sem interface: so o bot, sem menu
+    if (jogos > 0) {
+        liberarFila(&fila);
+        liberarPilha(&pilha);
+        Simulacao sim = {jogos, pecasMax, capFila, capPilha, tipo, semente, previsao, caminhoRegistro, 0, NULL};
+        return simular(&sim, threads) ? 0 : 1;
+    }
+
+    // Reconstroi fila, pilha e tabuleiro a partir de um registro gravado
+    if (caminhoReproduzir) {
+        FILE *arq = fopen(caminhoReproduzir, "rb");
+        liberarFila(&fila);
+        liberarPilha(&pilha);
+        inicializarFilaCapacidade(&fila, TAM_FILA, 1);
+        inicializarPilhaCapacidade(&pilha, TAM_PILHA, 1);
+        long n = arq ? reproduzirRegistro(arq, ate, &fila, &pilha, &tabuleiro) : -1;
+        if (arq) fclose(arq);
+        if (n < 0) {
+            printf("Registro invalido ou ilegivel: %s\n", caminhoReproduzir);
+        } else {
+            printf("Estado apos %ld eventos:\n", n);
+            inicializarRenderizador(&tela, fila.quantidade + pilha.topo + 1, 0);
+            exibirEstado(&tela, &fila, &pilha, &tabuleiro, NULL);
+            liberarRenderizador(&tela);
+        }
+        liberarFila(&fila);
+        liberarPilha(&pilha);
+        return n < 0;
+    }
+
+    if (caminhoRegistro) {
+        arquivoRegistro = fopen(caminhoRegistro, "wb");
+        if (!arquivoRegistro || !iniciarRegistro(&registro, arquivoRegistro)) {
+            printf("Nao foi possivel gravar o registro em %s\n", caminhoRegistro);
+            return 1;
+        }
+        reg = &registro;
+    }
+
+    // Preenche a fila inicialmente (em lote, direto no vetor da fila)
+    completarFila(&fila, &sorteadorJogo);
+    for (int i = 0; i < fila.quantidade; i++) registrarGerada(reg, pecaNaFila(&fila, i));
+
+    static const char menu[] =
+        "\nOpcoes disponíveis:\n"
+        "1 - Jogar peca da frente da fila\n"
+        "2 - Enviar peca da fila para a pilha de reserva\n"
+        "3 - Usar peca da pilha de reserva\n"
+        "4 - Trocar frente da fila com topo da pilha\n"
+        "5 - Troca multipla (k da fila <-> k da pilha)\n"
+        "6 - Benchmark da fila sem travas (produtor/consumidor)\n"
+        "7 - Benchmark dos sorteadores de pecas\n"
+        "8 - Benchmark do tabuleiro (colocacoes por segundo)\n"
+        "9 - Benchmark do registro de eventos\n"
+        "10 - Devolver peca da reserva para a frente da fila\n"
+        "0 - Sair\n"
+        "\nOpcao: ";
+    inicializarRenderizador(&tela, capFila + capPilha, silencioso);
 
     int opc;
 
     do {
-        printf("\n===========================================================\n");
-        printf("                    ESTADO ATUAL DO JOGO\n");
-        printf("===========================================================\n");
-        exibirEstado(&fila, &pilha);
-
-        printf("\nOpcoes disponíveis:\n");
-        printf("1 - Jogar peca da frente da fila\n");
-        printf("2 - Enviar peca da fila para a pilha de reserva\n");
-        printf("3 - Usar peca da pilha de reserva\n");
-        printf("4 - Trocar frente da fila com topo da pilha\n");
-        printf("5 - Troca multipla (3 da fila <-> 3 da pilha)\n");
-        printf("0 - Sair\n");
-
-        printf("\nOpcao: ");
-        scanf("%d", &opc);
+        exibirEstado(&tela, &fila, &pilha, &tabuleiro, menu);
+
+        int lidos = scanf("%d", &opc);
+        if (lidos == EOF) {
+            opc = 0; // fim da entrada (menu roteirizado)
+        } else if (lidos != 1) {
+            descartarLinha();
+            opc = -1; // cai em "Opcao invalida"
+        }
 
         switch(opc) {
 
         case 1: { // Jogar peça
-            if (!filaVazia(&fila)) {
+            Jogada feita;
+            if (!filaVazia(&fila) && jogarNoTabuleiro(&tabuleiro, fila.itens[fila.inicio], &feita)) {
                 Peca jogada = dequeue(&fila);
-                printf("\nPeca jogada: [%c %d]\n", jogada.nome, jogada.id);
-                enqueue(&fila, gerarPeca()); // repõe a fila
+                registrarJogada(reg, EVENTO_JOGADA, feita);
+                printf("\nPeca jogada: [%c %d]\n", nomePeca(jogada), idPeca(jogada));
+                if (fila.quantidade < capFila) reporPeca(&fila, reg); // repõe a fila
             }
             break;
         }
@@ -105,29 +519,84 @@ int main() {
             } else {
                 Peca px = dequeue(&fila);
                 push(&pilha, px);
-                printf("\nPeca [%c %d] movida para a reserva.\n", px.nome, px.id);
-                enqueue(&fila, gerarPeca());
+                registrarEvento(reg, EVENTO_RESERVADA);
+                printf("\nPeca [%c %d] movida para a reserva.\n", nomePeca(px), idPeca(px));
+                if (fila.quantidade < capFila) reporPeca(&fila, reg);
             }
             break;
         }
 
         case 3: { // Usar peça reservada
+            Jogada feita;
             if (pilhaVazia(&pilha)) {
                 printf("\nPilha vazia! Nenhuma peca para usar.\n");
-            } else {
+            } else if (jogarNoTabuleiro(&tabuleiro, pilha.itens[pilha.topo], &feita)) {
                 Peca usada = pop(&pilha);
-                printf("\nPeca usada: [%c %d]\n", usada.nome, usada.id);
+                registrarJogada(reg, EVENTO_USADA, feita);
+                printf("\nPeca usada: [%c %d]\n", nomePeca(usada), idPeca(usada));
             }
             break;
         }
 
         case 4: { // Troca topo <-> fila
-            trocarTopo(&fila, &pilha);
+            if (trocarTopo(&fila, &pilha)) {
+                registrarEvento(reg, EVENTO_TROCA_TOPO);
+                printf("\nTroca realizada entre frente da fila e topo da pilha.\n");
+            } else if (pilhaVazia(&pilha)) {
+                printf("\nPilha vazia! Nao ha como trocar.\n");
+            } else {
+                printf("\nFila vazia! Nao ha como trocar.\n");
+            }
             break;
         }
 
         case 5: { // Troca múltipla
-            trocaMultipla(&fila, &pilha);
+            int k;
+            printf("\nQuantas pecas trocar? ");
+            if (scanf("%d", &k) != 1) {
+                descartarLinha();
+                printf("\nQuantidade invalida: digite um numero inteiro.\n");
+            } else if (k < 1) {
+                printf("\nQuantidade invalida: troque pelo menos 1 peca.\n");
+            } else if (trocaMultipla(&fila, &pilha, k)) {
+                registrarTrocaMultipla(reg, k);
+                printf("\nTroca multipla realizada (%d da fila <-> %d da pilha).\n", k, k);
+            } else {
+                printf("\nNao ha %d pecas em ambas as estruturas. Troca impossivel.\n", k);
+            }
+            break;
+        }
+
+        case 6: {
+            benchmarkAnel();
+            break;
+        }
+
+        case 7: {
+            benchmarkSorteio();
+            break;
+        }
+
+        case 8: {
+            benchmarkTabuleiro();
+            break;
+        }
+
+        case 9: {
+            benchmarkRegistro();
+            break;
+        }
+
+        case 10: { // Devolver (hold): topo da pilha volta a frente da fila
+            if (pilhaVazia(&pilha)) {
+                printf("\nPilha vazia! Nenhuma peca para devolver.\n");
+            } else if (!enqueueFrente(&fila, pilha.itens[pilha.topo])) {
+                printf("\nFila cheia! Nao e possivel devolver.\n");
+            } else {
+                Peca devolvida = pop(&pilha);
+                registrarEvento(reg, EVENTO_DEVOLVIDA);
+                printf("\nPeca [%c %d] devolvida para a frente da fila.\n", nomePeca(devolvida), idPeca(devolvida));
+            }
             break;
         }
 
@@ -142,6 +611,17 @@ int main() {
 
     } while (opc != 0);
 
+    if (tela.quadros > 0)
+        printf("Renderizacao: %ld quadros, %.2f us por quadro\n", tela.quadros, tela.nsTotal / 1e3 / tela.quadros);
+    liberarRenderizador(&tela);
+    if (reg) {
+        if (!finalizarRegistro(reg) | (fclose(arquivoRegistro) != 0))
+            printf("Erro ao gravar o registro em %s\n", caminhoRegistro);
+        else
+            printf("Registro: %ld eventos em %s\n", registro.eventos, caminhoRegistro);
+    }
+    liberarFila(&fila);
+    liberarPilha(&pilha);
     return 0;
 }
 
@@ -149,57 +629,278 @@ int main() {
 // Inicialização
 // ------------------------------------------------------------
 void inicializarFila(Fila *f) {
+    f->itens = f->local;
+    f->capacidade = TAM_FILA;
+    f->crescer = 0;
     f->inicio = 0;
     f->fim = 0;
     f->quantidade = 0;
 }
 
 void inicializarPilha(Pilha *p) {
+    p->itens = p->local;
+    p->capacidade = TAM_PILHA;
+    p->crescer = 0;
     p->topo = -1;
 }
 
+// Capacidade definida em tempo de execucao; ate TAM_FILA nao aloca nada.
+// Retorna 0 se a capacidade for invalida ou faltar memoria.
+int inicializarFilaCapacidade(Fila *f, int capacidade, int crescer) {
+    inicializarFila(f);
+#ifdef FILA_PILHA_FIXAS
+    (void)crescer;
+    return capacidade == TAM_FILA;
+#else
+    if (capacidade < 1) return 0;
+    if (capacidade > TAM_FILA) {
+        f->itens = (Peca*) malloc((size_t)capacidade * sizeof(Peca));
+        if (!f->itens) { f->itens = f->local; return 0; }
+    }
+    f->capacidade = capacidade;
+    f->crescer = crescer;
+    return 1;
+#endif
+}
+
+int inicializarPilhaCapacidade(Pilha *p, int capacidade, int crescer) {
+    inicializarPilha(p);
+#ifdef FILA_PILHA_FIXAS
+    (void)crescer;
+    return capacidade == TAM_PILHA;
+#else
+    if (capacidade < 1) return 0;
+    if (capacidade > TAM_PILHA) {
+        p->itens = (Peca*) malloc((size_t)capacidade * sizeof(Peca));
+        if (!p->itens) { p->itens = p->local; return 0; }
+    }
+    p->capacidade = capacidade;
+    p->crescer = crescer;
+    return 1;
+#endif
+}
+
+void liberarFila(Fila *f) {
+    if (f->itens != f->local) free(f->itens);
+    inicializarFila(f);
+}
+
+void liberarPilha(Pilha *p) {
+    if (p->itens != p->local) free(p->itens);
+    inicializarPilha(p);
+}
+
 // ------------------------------------------------------------
 // Verificações
 // ------------------------------------------------------------
 int filaVazia(Fila *f) { return f->quantidade == 0; }
-int filaCheia(Fila *f) { return f->quantidade == TAM_FILA; }
+int filaCheia(Fila *f) { return f->quantidade == CAP_FILA(f); }
 int pilhaVazia(Pilha *p) { return p->topo == -1; }
-int pilhaCheia(Pilha *p) { return p->topo == TAM_PILHA - 1; }
+int pilhaCheia(Pilha *p) { return p->topo == CAP_PILHA(p) - 1; }
+
+// Indice no vetor do i-esimo elemento a partir da frente (sem %)
+int posicaoFila(Fila *f, int i) {
+    int pos = f->inicio + i;
+    return pos >= CAP_FILA(f) ? pos - CAP_FILA(f) : pos;
+}
+
+// i-esima peca a partir da frente (0 = frente), sem remover
+Peca pecaNaFila(Fila *f, int i) {
+    return f->itens[posicaoFila(f, i)];
+}
 
 // ------------------------------------------------------------
 // Geração de peça
 // ------------------------------------------------------------
+// xorshift64*: 8 bytes de estado, rapido e com boa qualidade nos bits altos
+static inline uint64_t proximoAleatorio(uint64_t *estado) {
+    uint64_t x = *estado;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *estado = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+// Inteiro uniforme em [0, n) sem o vies de %: multiplica e rejeita a sobra
+static inline uint32_t sortearAte(Sorteador *s, uint32_t n) {
+    uint64_t m = (proximoAleatorio(&s->estado) >> 32) * n;
+    if ((uint32_t)m < n) {
+        uint32_t limite = (0u - n) % n;
+        while ((uint32_t)m < limite) m = (proximoAleatorio(&s->estado) >> 32) * n;
+    }
+    return (uint32_t)(m >> 32);
+}
+
+// Cada peca independente das anteriores
+int tipoPuro(Sorteador *s) {
+    return (int)sortearAte(s, TOTAL_TIPOS);
+}
+
+// Saco de 7: cada tipo aparece uma vez a cada 7 pecas
+int tipoSaco(Sorteador *s) {
+    if (s->restantesSaco == 0) {
+        for (int i = 0; i < TOTAL_TIPOS; i++) s->saco[i] = (uint8_t)i;
+        s->restantesSaco = TOTAL_TIPOS;
+    }
+    int j = (int)sortearAte(s, (uint32_t)s->restantesSaco);
+    int t = s->saco[j];
+    s->saco[j] = s->saco[--s->restantesSaco];
+    return t;
+}
+
+// Historico: ressorteia ate HISTORICO_TENTATIVAS vezes se a peca saiu ha pouco;
+// a primeira peca nunca e O, S ou Z
+int tipoHistorico(Sorteador *s) {
+    int t;
+    if (s->primeira) {
+        do t = (int)sortearAte(s, TOTAL_TIPOS); while (t == 1 || t == 3 || t == 4);
+        s->primeira = 0;
+    } else {
+        for (int tentativa = 0; ; tentativa++) {
+            t = (int)sortearAte(s, TOTAL_TIPOS);
+            if (tentativa + 1 >= HISTORICO_TENTATIVAS) break;
+            // algum byte do historico igual a t? (byte zero apos o xor)
+            uint32_t x = s->historico ^ (0x01010101u * (uint32_t)t);
+            if (!((x - 0x01010101u) & ~x & 0x80808080u)) break;
+        }
+    }
+    s->historico = (s->historico << 8) | (uint32_t)t;
+    return t;
+}
+
+// Mesma semente + mesma estrategia = mesma sequencia de pecas
+void inicializarSorteador(Sorteador *s, TipoSorteio tipo, uint64_t semente) {
+    // splitmix64 espalha sementes pequenas (0, 1, 2...) e evita estado zero
+    uint64_t z = semente + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    s->estado = z ? z : 0x9E3779B97F4A7C15ULL;
+    s->proximoTipo = tipo == SORTEIO_PURO ? tipoPuro : tipo == SORTEIO_HISTORICO ? tipoHistorico : tipoSaco;
+    s->restantesSaco = 0;
+    s->historico = 0x04030403u; // Z S Z S
+    s->primeira = 1;
+    s->proximoId = 0;
+}
+
+Peca proximaPeca(Sorteador *s) {
+    return criarPeca(s->proximoTipo(s), s->proximoId++);
+}
+
+void gerarLotePecas(Sorteador *s, Peca *destino, int n) {
+    for (int i = 0; i < n; i++) destino[i] = proximaPeca(s);
+}
+
+// Completa a fila (ate ALVO_FILA) gerando direto nos trechos livres do
+// vetor circular. Retorna quantas pecas foram geradas.
+int completarFila(Fila *f, Sorteador *s) {
+    int livres = ALVO_FILA(f) - f->quantidade;
+    if (livres <= 0) return 0;
+    int ateOFim = CAP_FILA(f) - f->fim;
+    int primeiro = livres < ateOFim ? livres : ateOFim;
+    gerarLotePecas(s, f->itens + f->fim, primeiro);
+    gerarLotePecas(s, f->itens, livres - primeiro);
+    f->fim = f->fim + livres >= CAP_FILA(f) ? f->fim + livres - CAP_FILA(f) : f->fim + livres;
+    f->quantidade += livres;
+    return livres;
+}
+
 Peca gerarPeca() {
-    char tipos[] = {'I', 'O', 'T', 'L'};
-    Peca p;
-    p.nome = tipos[rand() % 4];
-    p.id = contadorID++;
-    return p;
+    return proximaPeca(&sorteadorJogo);
 }
 
 // ------------------------------------------------------------
 // Operações da fila circular
 // ------------------------------------------------------------
-void enqueue(Fila *f, Peca p) {
-    if (filaCheia(f)) return;
+#ifndef FILA_PILHA_FIXAS
+// Dobra a capacidade, desenrolando o anel para o inicio do vetor novo
+int crescerFila(Fila *f) {
+    if (f->capacidade > INT_MAX / 2) return 0;
+    int nova = f->capacidade * 2;
+    Peca *itens = (Peca*) malloc((size_t)nova * sizeof(Peca));
+    if (!itens) return 0;
+    for (int i = 0; i < f->quantidade; i++) itens[i] = pecaNaFila(f, i);
+    if (f->itens != f->local) free(f->itens);
+    f->itens = itens;
+    f->capacidade = nova;
+    f->inicio = 0;
+    f->fim = f->quantidade;
+    return 1;
+}
+
+int crescerPilha(Pilha *p) {
+    if (p->capacidade > INT_MAX / 2) return 0;
+    int nova = p->capacidade * 2;
+    Peca *itens = p->itens == p->local ? (Peca*) malloc((size_t)nova * sizeof(Peca))
+                                       : (Peca*) realloc(p->itens, (size_t)nova * sizeof(Peca));
+    if (!itens) return 0;
+    if (p->itens == p->local) memcpy(itens, p->local, (size_t)(p->topo + 1) * sizeof(Peca));
+    p->itens = itens;
+    p->capacidade = nova;
+    return 1;
+}
+#endif
+
+// Retorna 1 se inseriu; 0 se a fila estava cheia (e nao pode crescer)
+int enqueue(Fila *f, Peca p) {
+    if (filaCheia(f)) {
+#ifdef FILA_PILHA_FIXAS
+        return 0;
+#else
+        if (!f->crescer || !crescerFila(f)) return 0;
+#endif
+    }
     f->itens[f->fim] = p;
-    f->fim = (f->fim + 1) % TAM_FILA;
+    f->fim = f->fim + 1 == CAP_FILA(f) ? 0 : f->fim + 1;
     f->quantidade++;
+    return 1;
 }
 
 Peca dequeue(Fila *f) {
     Peca p = f->itens[f->inicio];
-    f->inicio = (f->inicio + 1) % TAM_FILA;
+    f->inicio = f->inicio + 1 == CAP_FILA(f) ? 0 : f->inicio + 1;
     f->quantidade--;
     return p;
 }
 
+// Insere antes da frente (ex.: peca devolvida da reserva).
+// Retorna 1 se inseriu; 0 se a fila estava cheia (e nao pode crescer)
+int enqueueFrente(Fila *f, Peca p) {
+    if (filaCheia(f)) {
+#ifdef FILA_PILHA_FIXAS
+        return 0;
+#else
+        if (!f->crescer || !crescerFila(f)) return 0;
+#endif
+    }
+    f->inicio = f->inicio == 0 ? CAP_FILA(f) - 1 : f->inicio - 1;
+    f->itens[f->inicio] = p;
+    f->quantidade++;
+    return 1;
+}
+
+// Remove a ultima peca da fila
+Peca dequeueFim(Fila *f) {
+    f->fim = f->fim == 0 ? CAP_FILA(f) - 1 : f->fim - 1;
+    f->quantidade--;
+    return f->itens[f->fim];
+}
+
 // ------------------------------------------------------------
 // Operações da pilha
 // ------------------------------------------------------------
-void push(Pilha *p, Peca x) {
-    if (pilhaCheia(p)) return;
+// Retorna 1 se empilhou; 0 se a pilha estava cheia (e nao pode crescer)
+int push(Pilha *p, Peca x) {
+    if (pilhaCheia(p)) {
+#ifdef FILA_PILHA_FIXAS
+        return 0;
+#else
+        if (!p->crescer || !crescerPilha(p)) return 0;
+#endif
+    }
     p->itens[++p->topo] = x;
+    return 1;
 }
 
 Peca pop(Pilha *p) {
@@ -209,67 +910,965 @@ Peca pop(Pilha *p) {
 // ------------------------------------------------------------
 // Troca simples: topo da pilha ↔ frente da fila
 // ------------------------------------------------------------
-void trocarTopo(Fila *f, Pilha *p) {
-    if (pilhaVazia(p)) {
-        printf("\nPilha vazia! Nao ha como trocar.\n");
-        return;
-    }
-
-    if (filaVazia(f)) {
-        printf("\nFila vazia! Nao ha como trocar.\n");
-        return;
-    }
+// Retorna 1 se trocou; 0 se a fila ou a pilha estava vazia
+int trocarTopo(Fila *f, Pilha *p) {
+    if (pilhaVazia(p) || filaVazia(f)) return 0;
 
     int idx = f->inicio;
 
     Peca temp = f->itens[idx];
     f->itens[idx] = p->itens[p->topo];
     p->itens[p->topo] = temp;
-
-    printf("\nTroca realizada entre frente da fila e topo da pilha.\n");
+    return 1;
 }
 
 // ------------------------------------------------------------
-// Troca múltipla: 3 da fila ↔ 3 da pilha
+// Troca múltipla: k da fila ↔ k da pilha
 // ------------------------------------------------------------
-void trocaMultipla(Fila *f, Pilha *p) {
-    if (p->topo < 2 || f->quantidade < 3) {
-        printf("\nNao ha 3 pecas em ambas as estruturas. Troca impossivel.\n");
-        return;
+// Troca n pecas contiguas da fila com pilha[topo], pilha[topo-1], ...;
+// retorna o indice da pilha onde a proxima troca continua (-1 se acabou)
+static inline int trocarTrecho(Peca *fila, Peca *pilha, int topo, int n) {
+    for (int i = 0; i < n; i++, topo--) {
+        Peca temp = fila[i];
+        fila[i] = pilha[topo];
+        pilha[topo] = temp;
     }
+    return topo;
+}
 
-    int idx = f->inicio;
+/*
+  Troca as k pecas da frente da fila com as k do topo da pilha: a frente
+  recebe o topo, a segunda recebe a de baixo do topo, e assim por diante.
+  A parte da fila e no maximo dois trechos contiguos (antes e depois da
+  volta do anel), entao nao ha % por peca. Retorna 1 se trocou; 0 se nao
+  ha k pecas em ambas as estruturas.
+*/
+int trocaMultipla(Fila *f, Pilha *p, int k) {
+    if (k < 1 || p->topo + 1 < k || f->quantidade < k) return 0;
 
-    for (int i = 0; i < 3; i++) {
-        Peca temp = f->itens[(idx + i) % TAM_FILA];
-        f->itens[(idx + i) % TAM_FILA] = p->itens[p->topo - i];
-        p->itens[p->topo - i] = temp;
-    }
+    int ateOFim = CAP_FILA(f) - f->inicio;
+    int primeiro = k < ateOFim ? k : ateOFim;
+    int topo = trocarTrecho(f->itens + f->inicio, p->itens, p->topo, primeiro);
+    trocarTrecho(f->itens, p->itens, topo, k - primeiro);
+    return 1;
+}
 
-    printf("\nTroca multipla realizada (3 da fila <-> 3 da pilha).\n");
+// Descarta o resto da linha de entrada (depois de uma leitura que falhou)
+void descartarLinha(void) {
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF) {}
 }
 
 // ------------------------------------------------------------
-// Exibir o estado
+// Renderizacao
 // ------------------------------------------------------------
-void exibirEstado(Fila *f, Pilha *p) {
-    printf("\nFila de pecas:\n");
-    int idx = f->inicio;
+// 'pecas' = quantas pecas devem caber sem realocar (fila + pilha)
+void inicializarRenderizador(Renderizador *r, int pecas, int silencioso) {
+    r->capacidade = RENDER_FIXO + (size_t)(pecas > 0 ? pecas : 0) * RENDER_POR_PECA;
+    r->buffer = (char*) malloc(r->capacidade);
+    if (!r->buffer) {
+        fprintf(stderr, "Erro: sem memoria para o renderizador.\n");
+        exit(EXIT_FAILURE);
+    }
+    r->usado = 0;
+    r->silencioso = silencioso;
+    r->quadros = 0;
+    r->nsTotal = 0;
+}
+
+void liberarRenderizador(Renderizador *r) {
+    free(r->buffer);
+    r->buffer = NULL;
+    r->capacidade = 0;
+}
+
+static inline void textoRender(Renderizador *r, const char *s, size_t n) {
+    memcpy(r->buffer + r->usado, s, n);
+    r->usado += n;
+}
+
+#define TEXTO_RENDER(r, literal) textoRender((r), (literal), sizeof(literal) - 1)
+
+// Inteiro sem sinal, sem passar por printf
+static inline void numeroRender(Renderizador *r, unsigned long v) {
+    char tmp[20];
+    int n = 0;
+    do { tmp[n++] = (char)('0' + v % 10); v /= 10; } while (v);
+    while (n) r->buffer[r->usado++] = tmp[--n];
+}
+
+static inline void pecaRender(Renderizador *r, Peca p) {
+    r->buffer[r->usado++] = '[';
+    r->buffer[r->usado++] = nomePeca(p);
+    r->buffer[r->usado++] = ' ';
+    numeroRender(r, (unsigned long)idPeca(p));
+    TEXTO_RENDER(r, "] ");
+}
+
+/*
+  Monta cabecalho, tabuleiro, fila, pilha e o rodape (menu, pode ser NULL)
+  no buffer e escreve tudo com um unico fwrite. Nao faz nada no modo
+  silencioso. O buffer so cresce se a fila/pilha passar do previsto.
+*/
+void exibirEstado(Renderizador *r, Fila *f, Pilha *p, Tabuleiro *t, const char *rodape) {
+    if (r->silencioso) return;
+    long long t0 = agoraNs();
+
+    size_t tamRodape = rodape ? strlen(rodape) : 0;
+    size_t necessario = RENDER_FIXO + tamRodape + (size_t)(f->quantidade + p->topo + 1) * RENDER_POR_PECA;
+    if (necessario > r->capacidade) {
+        char *novo = (char*) realloc(r->buffer, necessario);
+        if (!novo) {
+            fprintf(stderr, "Erro: sem memoria para o renderizador.\n");
+            exit(EXIT_FAILURE);
+        }
+        r->buffer = novo;
+        r->capacidade = necessario;
+    }
+    r->usado = 0;
+
+    TEXTO_RENDER(r, "\n===========================================================\n"
+                    "                    ESTADO ATUAL DO JOGO\n"
+                    "===========================================================\n");
 
-    for (int i = 0; i < f->quantidade; i++) {
-        Peca px = f->itens[(idx + i) % TAM_FILA];
-        printf("[%c %d] ", px.nome, px.id);
+    TEXTO_RENDER(r, "\nTabuleiro (linhas: ");
+    numeroRender(r, (unsigned long)t->linhasLimpas);
+    TEXTO_RENDER(r, "):\n");
+    for (int y = ALTURA_VISIVEL - 1; y >= 0; y--) {
+        r->buffer[r->usado++] = '|';
+        for (int x = 0; x < LARGURA_TABULEIRO; x++)
+            r->buffer[r->usado++] = (t->linhas[y] >> x) & 1 ? '#' : '.';
+        TEXTO_RENDER(r, "|\n");
     }
+    TEXTO_RENDER(r, " 0123456789\n");
 
-    printf("\n\nPilha de reserva (Topo -> Base):\n");
+    TEXTO_RENDER(r, "\nFila de pecas:\n");
+    for (int i = 0; i < f->quantidade; i++) pecaRender(r, pecaNaFila(f, i));
 
+    TEXTO_RENDER(r, "\n\nPilha de reserva (Topo -> Base):\n");
     if (pilhaVazia(p)) {
-        printf("[vazia]");
+        TEXTO_RENDER(r, "[vazia]");
     } else {
-        for (int i = p->topo; i >= 0; i--) {
-            printf("[%c %d] ", p->itens[i].nome, p->itens[i].id);
+        for (int i = p->topo; i >= 0; i--) pecaRender(r, p->itens[i]);
+    }
+    TEXTO_RENDER(r, "\n");
+    if (rodape) textoRender(r, rodape, tamRodape);
+
+    fwrite(r->buffer, 1, r->usado, stdout);
+    r->nsTotal += agoraNs() - t0;
+    r->quadros++;
+}
+
+// ------------------------------------------------------------
+// Anel SPSC: operacoes
+// ------------------------------------------------------------
+int inicializarAnel(AnelSPSC *a, size_t capacidade) {
+    if (capacidade < 2 || (capacidade & (capacidade - 1)) != 0) return 0;
+    a->itens = (Peca*) malloc(capacidade * sizeof(Peca));
+    if (!a->itens) return 0;
+    a->mascara = capacidade - 1;
+    atomic_init(&a->cauda, 0);
+    atomic_init(&a->cabeca, 0);
+    a->cabecaVista = a->caudaVista = 0;
+    return 1;
+}
+
+void liberarAnel(AnelSPSC *a) {
+    free(a->itens);
+    a->itens = NULL;
+}
+
+// Mesma semantica de enqueue(): nao insere se estiver cheio (retorna 0)
+int enqueueAnel(AnelSPSC *a, Peca p) {
+    size_t cauda = atomic_load_explicit(&a->cauda, memory_order_relaxed);
+    if (cauda - a->cabecaVista > a->mascara) {
+        a->cabecaVista = atomic_load_explicit(&a->cabeca, memory_order_acquire);
+        if (cauda - a->cabecaVista > a->mascara) return 0;
+    }
+    a->itens[cauda & a->mascara] = p;
+    atomic_store_explicit(&a->cauda, cauda + 1, memory_order_release);
+    return 1;
+}
+
+// Retorna 0 se estiver vazio (dequeue() da fila comum exige fila nao vazia)
+int dequeueAnel(AnelSPSC *a, Peca *p) {
+    size_t cabeca = atomic_load_explicit(&a->cabeca, memory_order_relaxed);
+    if (cabeca == a->caudaVista) {
+        a->caudaVista = atomic_load_explicit(&a->cauda, memory_order_acquire);
+        if (cabeca == a->caudaVista) return 0;
+    }
+    *p = a->itens[cabeca & a->mascara];
+    atomic_store_explicit(&a->cabeca, cabeca + 1, memory_order_release);
+    return 1;
+}
+
+// Lotes: um unico store atomico publica todas as pecas copiadas
+size_t enqueueLoteAnel(AnelSPSC *a, const Peca *pecas, size_t n) {
+    size_t cauda = atomic_load_explicit(&a->cauda, memory_order_relaxed);
+    size_t livre = a->mascara + 1 - (cauda - a->cabecaVista);
+    if (livre < n) {
+        a->cabecaVista = atomic_load_explicit(&a->cabeca, memory_order_acquire);
+        livre = a->mascara + 1 - (cauda - a->cabecaVista);
+        if (n > livre) n = livre;
+    }
+    size_t inicio = cauda & a->mascara, ate = a->mascara + 1 - inicio;
+    if (ate > n) ate = n;
+    memcpy(a->itens + inicio, pecas, ate * sizeof(Peca));
+    memcpy(a->itens, pecas + ate, (n - ate) * sizeof(Peca)); // volta ao inicio do vetor
+    atomic_store_explicit(&a->cauda, cauda + n, memory_order_release);
+    return n;
+}
+
+size_t dequeueLoteAnel(AnelSPSC *a, Peca *pecas, size_t max) {
+    size_t cabeca = atomic_load_explicit(&a->cabeca, memory_order_relaxed);
+    size_t disponivel = a->caudaVista - cabeca;
+    if (disponivel < max) {
+        a->caudaVista = atomic_load_explicit(&a->cauda, memory_order_acquire);
+        disponivel = a->caudaVista - cabeca;
+    }
+    size_t n = disponivel < max ? disponivel : max;
+    size_t inicio = cabeca & a->mascara, ate = a->mascara + 1 - inicio;
+    if (ate > n) ate = n;
+    memcpy(pecas, a->itens + inicio, ate * sizeof(Peca));
+    memcpy(pecas + ate, a->itens, (n - ate) * sizeof(Peca));
+    atomic_store_explicit(&a->cabeca, cabeca + n, memory_order_release);
+    return n;
+}
+
+// ------------------------------------------------------------
+// Benchmark do anel: uma thread gera pecas, a outra consome
+// ------------------------------------------------------------
+typedef struct {
+    AnelSPSC *anel;
+    long total;
+    size_t lote; // 1 = enqueueAnel peca a peca
+} ProdutorAnel;
+
+long long agoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void* produzirPecas(void *arg) {
+    ProdutorAnel *pr = (ProdutorAnel*) arg;
+    Peca lote[BENCH_ANEL_LOTE];
+    long id = 0;
+    while (id < pr->total) {
+        size_t n = 0;
+        while (n < pr->lote && id + (long)n < pr->total) {
+            lote[n] = criarPeca((int)((id + n) & 3), (uint32_t)(id + n));
+            n++;
+        }
+        size_t enviados = 0;
+        while (enviados < n) {
+            size_t k = pr->lote == 1 ? (size_t)enqueueAnel(pr->anel, lote[0])
+                                     : enqueueLoteAnel(pr->anel, lote + enviados, n - enviados);
+            if (k == 0) sched_yield(); // cheio: deixa o consumidor andar
+            enviados += k;
+        }
+        id += (long)n;
+    }
+    return NULL;
+}
+
+// Consome tudo conferindo a ordem dos ids; retorna o numero de erros
+long consumirPecas(AnelSPSC *anel, long total, size_t lote) {
+    Peca recebidas[BENCH_ANEL_LOTE];
+    long esperado = 0, erros = 0;
+    while (esperado < total) {
+        size_t n = lote == 1 ? (size_t)dequeueAnel(anel, recebidas) : dequeueLoteAnel(anel, recebidas, lote);
+        if (n == 0) { sched_yield(); continue; }
+        for (size_t i = 0; i < n; i++, esperado++)
+            if (idPeca(recebidas[i]) != (int)esperado) erros++;
+    }
+    return erros;
+}
+
+void benchmarkAnel(void) {
+    size_t lotes[] = {1, BENCH_ANEL_LOTE};
+    printf("\nAnel SPSC: capacidade %d, %d pecas por rodada\n", BENCH_ANEL_CAPACIDADE, BENCH_ANEL_PECAS);
+    printf("%-12s %14s %10s %8s\n", "MODO", "OPS/S", "MS", "ERROS");
+    for (int m = 0; m < 2; m++) {
+        AnelSPSC anel;
+        if (!inicializarAnel(&anel, BENCH_ANEL_CAPACIDADE)) {
+            printf("Falha ao alocar o anel.\n");
+            return;
+        }
+        ProdutorAnel pr = {&anel, BENCH_ANEL_PECAS, lotes[m]};
+        pthread_t produtor;
+        long long t0 = agoraNs();
+        if (pthread_create(&produtor, NULL, produzirPecas, &pr) != 0) {
+            printf("Falha ao criar a thread produtora.\n");
+            liberarAnel(&anel);
+            return;
+        }
+        long erros = consumirPecas(&anel, BENCH_ANEL_PECAS, lotes[m]);
+        pthread_join(produtor, NULL);
+        long long t1 = agoraNs();
+        char modo[16];
+        snprintf(modo, sizeof(modo), lotes[m] == 1 ? "unitario" : "lote %zu", lotes[m]);
+        printf("%-12s %14.0f %10.1f %8ld\n", modo, BENCH_ANEL_PECAS / ((t1 - t0) / 1e9), (t1 - t0) / 1e6, erros);
+        liberarAnel(&anel);
+    }
+}
+
+// ------------------------------------------------------------
+// Benchmark dos sorteadores (semente fixa: resultados reproduziveis)
+// ------------------------------------------------------------
+void benchmarkSorteio(void) {
+    static Peca lote[BENCH_SORTEIO_LOTE];
+    const char *nomes[] = {"puro", "saco 7", "historico"};
+    printf("\nSorteio: %d pecas por estrategia, semente 42\n", BENCH_SORTEIO_PECAS);
+    printf("%-10s %14s %10s %10s %12s\n", "ESTRATEGIA", "PECAS/S", "MS", "SECA MAX", "DESVIO MAX");
+
+    // Referencia: o gerador antigo (rand() % 4)
+    long long t0 = agoraNs();
+    unsigned soma = 0;
+    for (long i = 0; i < BENCH_SORTEIO_PECAS; i++) soma += (unsigned)(rand() % 4);
+    long long t1 = agoraNs();
+    printf("%-10s %14.0f %10.1f %10s %12s (soma %u)\n", "rand()%4",
+           BENCH_SORTEIO_PECAS / ((t1 - t0) / 1e9), (t1 - t0) / 1e6, "-", "-", soma);
+
+    for (int e = 0; e < 3; e++) {
+        Sorteador s;
+        inicializarSorteador(&s, (TipoSorteio)e, 42);
+        long contagem[TOTAL_TIPOS] = {0}, ultimo[TOTAL_TIPOS], secaMax = 0;
+        for (int i = 0; i < TOTAL_TIPOS; i++) ultimo[i] = -1;
+
+        t0 = agoraNs();
+        for (long feitos = 0; feitos < BENCH_SORTEIO_PECAS; feitos += BENCH_SORTEIO_LOTE) {
+            gerarLotePecas(&s, lote, BENCH_SORTEIO_LOTE);
+            contagem[tipoPeca(lote[BENCH_SORTEIO_LOTE - 1])]++; // impede o descarte do lote
+        }
+        t1 = agoraNs();
+
+        // Segunda passada (fora do tempo) para medir a distribuicao
+        inicializarSorteador(&s, (TipoSorteio)e, 42);
+        memset(contagem, 0, sizeof(contagem));
+        for (long i = 0; i < BENCH_SORTEIO_PECAS; i++) {
+            int c = tipoPeca(proximaPeca(&s));
+            if (i - ultimo[c] - 1 > secaMax && ultimo[c] >= 0) secaMax = i - ultimo[c] - 1;
+            ultimo[c] = i;
+            contagem[c]++;
+        }
+        double esperado = BENCH_SORTEIO_PECAS / (double)TOTAL_TIPOS, desvio = 0;
+        for (int t = 0; t < TOTAL_TIPOS; t++) {
+            double d = (contagem[t] - esperado) / esperado;
+            if (d < 0) d = -d;
+            if (d > desvio) desvio = d;
+        }
+        printf("%-10s %14.0f %10.1f %10ld %11.4f%%\n", nomes[e],
+               BENCH_SORTEIO_PECAS / ((t1 - t0) / 1e9), (t1 - t0) / 1e6, secaMax, desvio * 100);
+    }
+}
+
+// ------------------------------------------------------------
+// Tabuleiro (bitboard)
+// ------------------------------------------------------------
+// Rotacoes em grade 4x4, uma linha por nibble (de cima para baixo) e a
+// coluna da esquerda no bit mais alto do nibble
+static const uint16_t GRADES_PECA[TOTAL_TIPOS][4] = {
+    {0x0F00, 0x2222, 0x00F0, 0x4444}, // I
+    {0x6600, 0x6600, 0x6600, 0x6600}, // O
+    {0x4E00, 0x4640, 0x0E40, 0x4C40}, // T
+    {0x6C00, 0x4620, 0x06C0, 0x8C40}, // S
+    {0xC600, 0x2640, 0x0C60, 0x4C80}, // Z
+    {0x8E00, 0x6440, 0x0E20, 0x44C0}, // J
+    {0x2E00, 0x4460, 0x0E80, 0xC440}, // L
+};
+
+// Converte as grades em mascaras de linha encostadas embaixo e a esquerda
+void prepararFormas(void) {
+    for (int t = 0; t < TOTAL_TIPOS; t++) {
+        for (int r = 0; r < 4; r++) {
+            uint16_t linhas[4] = {0, 0, 0, 0};
+            int n = 0;
+            for (int y = 3; y >= 0; y--) { // de baixo para cima
+                int nibble = (GRADES_PECA[t][r] >> (12 - 4 * y)) & 0xF;
+                uint16_t m = 0;
+                for (int x = 0; x < 4; x++)
+                    if (nibble & (8 >> x)) m |= (uint16_t)(1u << x);
+                if (m || n > 0) linhas[n++] = m;
+            }
+            while (n > 0 && linhas[n - 1] == 0) n--;
+            uint16_t todas = linhas[0] | linhas[1] | linhas[2] | linhas[3];
+            int desloca = __builtin_ctz(todas);
+            FormaPeca *f = &formas[t][r];
+            for (int y = 0; y < 4; y++) f->linhas[y] = (uint16_t)(linhas[y] >> desloca);
+            f->largura = (uint8_t)(32 - __builtin_clz(todas) - desloca);
+            f->altura = (uint8_t)n;
+        }
+    }
+}
+
+void limparTabuleiro(Tabuleiro *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+// As 4 linhas da peca contra as 4 linhas do tabuleiro a partir de y
+static inline int colide(const Tabuleiro *t, const uint16_t m[4], int y) {
+    return ((t->linhas[y] & m[0]) | (t->linhas[y + 1] & m[1]) |
+            (t->linhas[y + 2] & m[2]) | (t->linhas[y + 3] & m[3])) != 0;
+}
+
+/*
+  Solta a peca (queda direta) na coluna indicada e limpa as linhas completas.
+  Retorna o numero de linhas limpas, POSICAO_INVALIDA se a peca nao cabe
+  na coluna ou FIM_DE_JOGO se ela parar acima da area do tabuleiro.
+*/
+int colocarPeca(Tabuleiro *t, int tipo, int rotacao, int coluna) {
+    const FormaPeca *f = &formas[tipo][rotacao & 3];
+    if (coluna < 0 || coluna + f->largura > LARGURA_TABULEIRO) return POSICAO_INVALIDA;
+
+    uint16_t m[4];
+    for (int i = 0; i < 4; i++) m[i] = (uint16_t)(f->linhas[i] << coluna);
+
+    // acima de 'altura' tudo e vazio: comeca ali e desce ate encostar
+    int y = t->altura;
+    while (y > 0 && !colide(t, m, y - 1)) y--;
+    if (y + f->altura > ALTURA_TABULEIRO) return FIM_DE_JOGO;
+
+    for (int i = 0; i < 4; i++) t->linhas[y + i] |= m[i];
+    if (y + f->altura > t->altura) t->altura = y + f->altura;
+    t->celulas += 4;
+    t->pecasColocadas++;
+
+    // So as linhas tocadas pela peca podem ter completado
+    int cheias = 0;
+    for (int i = 0; i < f->altura; i++) cheias += t->linhas[y + i] == LINHA_CHEIA;
+    if (cheias == 0) return 0;
+
+    // Compacta: copia para baixo as linhas que nao estao cheias
+    int destino = y;
+    for (int r = y; r < t->altura; r++)
+        if (t->linhas[r] != LINHA_CHEIA) t->linhas[destino++] = t->linhas[r];
+    for (int r = destino; r < t->altura; r++) t->linhas[r] = 0;
+    t->altura = destino;
+    t->celulas -= cheias * LARGURA_TABULEIRO;
+    t->linhasLimpas += cheias;
+    return cheias;
+}
+
+// Pede rotacao e coluna e solta a peca. Retorna 1 se a peca foi consumida
+// (e a jogada feita em 'feita').
+int jogarNoTabuleiro(Tabuleiro *t, Peca p, Jogada *feita) {
+    int tipo = tipoPeca(p), rotacao, coluna;
+
+    printf("\nPeca [%c %d] - rotacao (0-3) e coluna (0-%d): ", nomePeca(p), idPeca(p), LARGURA_TABULEIRO - 1);
+    if (scanf("%d %d", &rotacao, &coluna) != 2) return 0;
+
+    int r = colocarPeca(t, tipo, rotacao, coluna);
+    if (r == POSICAO_INVALIDA) {
+        printf("\nA peca nao cabe nessa coluna.\n");
+        return 0;
+    }
+    feita->rotacao = rotacao & 3;
+    feita->coluna = coluna;
+    if (r == FIM_DE_JOGO) {
+        printf("\nFim de jogo! %ld pecas, %ld linhas. O tabuleiro foi reiniciado.\n",
+               t->pecasColocadas, t->linhasLimpas);
+        limparTabuleiro(t);
+    } else if (r > 0) {
+        printf("\n%d linha(s) limpa(s)!\n", r);
+    }
+    return 1;
+}
+
+// Roteiro de jogadas sorteado antes (fora do tempo) e repetido em ciclo
+void benchmarkTabuleiro(void) {
+    static uint8_t tipos[BENCH_TABULEIRO_ROTEIRO], rotacoes[BENCH_TABULEIRO_ROTEIRO], colunas[BENCH_TABULEIRO_ROTEIRO];
+    Sorteador s;
+    inicializarSorteador(&s, SORTEIO_SACO, 42);
+    for (int i = 0; i < BENCH_TABULEIRO_ROTEIRO; i++) {
+        tipos[i] = (uint8_t)s.proximoTipo(&s);
+        rotacoes[i] = (uint8_t)sortearAte(&s, 4);
+        colunas[i] = (uint8_t)sortearAte(&s, LARGURA_TABULEIRO + 1 - formas[tipos[i]][rotacoes[i]].largura);
+    }
+
+    Tabuleiro t;
+    limparTabuleiro(&t);
+    long linhas = 0, partidas = 1;
+    long long t0 = agoraNs();
+    for (long i = 0; i < BENCH_TABULEIRO_JOGADAS; i++) {
+        int k = (int)(i & (BENCH_TABULEIRO_ROTEIRO - 1));
+        int r = colocarPeca(&t, tipos[k], rotacoes[k], colunas[k]);
+        if (r == FIM_DE_JOGO) {
+            linhas += t.linhasLimpas;
+            limparTabuleiro(&t);
+            partidas++;
+        }
+    }
+    long long t1 = agoraNs();
+    linhas += t.linhasLimpas;
+
+    printf("\nTabuleiro: %d jogadas aleatorias (semente 42)\n", BENCH_TABULEIRO_JOGADAS);
+    printf("%14.0f colocacoes/s  %.1f ms  %ld linhas limpas  %ld partidas\n",
+           BENCH_TABULEIRO_JOGADAS / ((t1 - t0) / 1e9), (t1 - t0) / 1e6, linhas, partidas);
+}
+
+// ------------------------------------------------------------
+// Bot e simulacao em lote
+// ------------------------------------------------------------
+// Rotacoes que geram formas diferentes (O: 1; I, S, Z: 2; T, J, L: 4)
+static const int ROTACOES_DISTINTAS[TOTAL_TIPOS] = {2, 1, 4, 2, 2, 4, 4};
+
+// Nota do tabuleiro sem o termo de linhas (somado por quem colocou a peca).
+// Varre de cima para baixo so ate achar o topo de todas as colunas; abaixo
+// do topo, toda celula vazia e buraco: buracos = soma das alturas - celulas.
+double avaliarTabuleiro(const Tabuleiro *t) {
+    int alturas[LARGURA_TABULEIRO] = {0};
+    uint16_t acima = 0;
+    for (int y = t->altura - 1; y >= 0 && acima != LINHA_CHEIA; y--) {
+        uint16_t novas = t->linhas[y] & (uint16_t)~acima;
+        acima |= novas;
+        while (novas) {
+            alturas[__builtin_ctz(novas)] = y + 1;
+            novas &= (uint16_t)(novas - 1);
         }
     }
+    int soma = 0, irregular = 0;
+    for (int x = 0; x < LARGURA_TABULEIRO; x++) {
+        soma += alturas[x];
+        if (x > 0) irregular += abs(alturas[x] - alturas[x - 1]);
+    }
+    return PESO_ALTURAS * soma + PESO_BURACOS * (soma - t->celulas) + PESO_IRREGULAR * irregular;
+}
+
+/*
+  Procura a melhor colocacao para tipos[0], olhando as n-1 pecas seguintes.
+  Retorna a nota (NOTA_DERROTA se nenhuma colocacao e possivel) e, se
+  'melhor' nao for NULL, a jogada escolhida para a primeira peca.
+*/
+double buscarJogada(const Tabuleiro *t, const int *tipos, int n, Jogada *melhor) {
+    double melhorNota = NOTA_DERROTA;
+    int achou = 0;
+    for (int r = 0; r < ROTACOES_DISTINTAS[tipos[0]]; r++) {
+        int colunas = LARGURA_TABULEIRO + 1 - formas[tipos[0]][r].largura;
+        for (int c = 0; c < colunas; c++) {
+            Tabuleiro copia = *t;
+            int linhas = colocarPeca(&copia, tipos[0], r, c);
+            if (linhas < 0) continue;
+            double nota = PESO_LINHAS * linhas +
+                          (n > 1 ? buscarJogada(&copia, tipos + 1, n - 1, NULL) : avaliarTabuleiro(&copia));
+            if (!achou || nota > melhorNota) {
+                achou = 1;
+                melhorNota = nota;
+                if (melhor) { melhor->rotacao = r; melhor->coluna = c; }
+            }
+        }
+    }
+    return melhorNota;
+}
+
+/*
+  Uma partida completa. A cada peca o bot compara quatro acoes, cada uma
+  com a peca que sera jogada agora e a que vem depois:
+    jogar a frente da fila        (fila[0], fila[1])
+    trocarTopo e jogar            (topo,    fila[1])
+    trocaMultipla e jogar         (topo,    pilha[topo-1])
+    reservar a frente e jogar     (fila[1], fila[2])
+  Retorna 0 se faltar memoria.
+*/
+int jogarPartida(Simulacao *sim, int jogo, ResultadoPartida *r) {
+    Fila f;
+    Pilha p;
+    Sorteador s;
+    Tabuleiro t;
+    if (!inicializarFilaCapacidade(&f, sim->capFila, 0)) return 0;
+    if (!inicializarPilhaCapacidade(&p, sim->capPilha, 0)) { liberarFila(&f); return 0; }
+    inicializarSorteador(&s, sim->sorteio, sim->semente + (uint64_t)jogo);
+    limparTabuleiro(&t);
+    completarFila(&f, &s);
+    memset(r, 0, sizeof(*r));
+
+    RegistroEventos registro, *reg = NULL;
+    FILE *arquivo = NULL;
+    if (sim->registro) {
+        char caminho[4096];
+        snprintf(caminho, sizeof(caminho), "%s.%d", sim->registro, jogo);
+        arquivo = fopen(caminho, "wb");
+        if (!arquivo || !iniciarRegistro(&registro, arquivo)) {
+            fprintf(stderr, "Erro: nao foi possivel gravar %s.\n", caminho);
+            exit(EXIT_FAILURE);
+        }
+        reg = &registro;
+        for (int i = 0; i < f.quantidade; i++) registrarGerada(reg, pecaNaFila(&f, i));
+    }
+
+    while (r->pecas < sim->pecasMax) {
+        int candidatos[TOTAL_ACOES][2], validos[TOTAL_ACOES] = {0};
+        int q0 = tipoPeca(pecaNaFila(&f, 0));
+        int q1 = f.quantidade > 1 ? tipoPeca(pecaNaFila(&f, 1)) : -1;
+        int q2 = f.quantidade > 2 ? tipoPeca(pecaNaFila(&f, 2)) : -1;
+        int s0 = p.topo >= 0 ? tipoPeca(p.itens[p.topo]) : -1;
+        int s1 = p.topo >= 1 ? tipoPeca(p.itens[p.topo - 1]) : -1;
+
+        candidatos[ACAO_JOGAR][0] = q0; candidatos[ACAO_JOGAR][1] = q1;
+        validos[ACAO_JOGAR] = 1;
+        candidatos[ACAO_TROCAR_TOPO][0] = s0; candidatos[ACAO_TROCAR_TOPO][1] = q1;
+        validos[ACAO_TROCAR_TOPO] = s0 >= 0;
+        candidatos[ACAO_TROCA_MULTIPLA][0] = s0; candidatos[ACAO_TROCA_MULTIPLA][1] = s1;
+        validos[ACAO_TROCA_MULTIPLA] = p.topo + 1 >= TROCA_PADRAO && f.quantidade >= TROCA_PADRAO;
+        candidatos[ACAO_RESERVAR][0] = q1; candidatos[ACAO_RESERVAR][1] = q2;
+        validos[ACAO_RESERVAR] = !pilhaCheia(&p) && q1 >= 0;
+
+        // Acoes com o mesmo par de pecas dao a mesma busca: calcula uma vez
+        int acao = -1;
+        double melhorNota = 0, notas[TOTAL_ACOES];
+        Jogada jogada = {0, 0}, jogadas[TOTAL_ACOES];
+        for (int a = 0; a < TOTAL_ACOES; a++) {
+            if (!validos[a]) continue;
+            if (!sim->previsao) candidatos[a][1] = -1;
+            int igual = -1;
+            for (int b = 0; b < a && igual < 0; b++)
+                if (validos[b] && candidatos[b][0] == candidatos[a][0] && candidatos[b][1] == candidatos[a][1]) igual = b;
+            if (igual >= 0) {
+                notas[a] = notas[igual];
+                jogadas[a] = jogadas[igual];
+            } else {
+                notas[a] = buscarJogada(&t, candidatos[a], candidatos[a][1] >= 0 ? 2 : 1, &jogadas[a]);
+            }
+            if (acao < 0 || notas[a] > melhorNota) { acao = a; melhorNota = notas[a]; jogada = jogadas[a]; }
+        }
+        if (melhorNota <= NOTA_DERROTA) { r->derrota = 1; break; }
+
+        if (acao == ACAO_TROCAR_TOPO) {
+            trocarTopo(&f, &p);
+            registrarEvento(reg, EVENTO_TROCA_TOPO);
+        } else if (acao == ACAO_TROCA_MULTIPLA) {
+            trocaMultipla(&f, &p, TROCA_PADRAO);
+            registrarTrocaMultipla(reg, TROCA_PADRAO);
+        } else if (acao == ACAO_RESERVAR) {
+            push(&p, dequeue(&f));
+            registrarEvento(reg, EVENTO_RESERVADA);
+            Peca nova = proximaPeca(&s);
+            enqueue(&f, nova);
+            registrarGerada(reg, nova);
+        }
+        r->acoes[acao]++;
+
+        Peca jogada0 = dequeue(&f);
+        int linhas = colocarPeca(&t, tipoPeca(jogada0), jogada.rotacao, jogada.coluna);
+        registrarJogada(reg, EVENTO_JOGADA, jogada);
+        Peca nova = proximaPeca(&s);
+        enqueue(&f, nova);
+        registrarGerada(reg, nova);
+        if (linhas < 0) { r->derrota = 1; break; }
+        r->linhas += linhas;
+        r->pecas++;
+    }
+
+    if (reg && (!finalizarRegistro(reg) | (fclose(arquivo) != 0))) {
+        fprintf(stderr, "Erro ao gravar o registro da partida %d.\n", jogo);
+        exit(EXIT_FAILURE);
+    }
+    liberarFila(&f);
+    liberarPilha(&p);
+    return 1;
+}
+
+void* trabalharSimulacao(void *arg) {
+    Simulacao *sim = (Simulacao*) arg;
+    for (;;) {
+        int jogo = atomic_fetch_add(&sim->proximoJogo, 1);
+        if (jogo >= sim->jogos) break;
+        if (!jogarPartida(sim, jogo, &sim->resultados[jogo])) {
+            fprintf(stderr, "Erro: sem memoria para a partida %d.\n", jogo);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return NULL;
+}
+
+// Roda as partidas em 'threads' threads e imprime o resumo. Retorna 0 em erro.
+int simular(Simulacao *sim, int threads) {
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS_SIM) threads = MAX_THREADS_SIM;
+    if (threads > sim->jogos) threads = sim->jogos;
+
+    sim->resultados = (ResultadoPartida*) calloc((size_t)sim->jogos, sizeof(ResultadoPartida));
+    if (!sim->resultados) {
+        printf("Sem memoria para os resultados.\n");
+        return 0;
+    }
+    atomic_store(&sim->proximoJogo, 0);
+
+    pthread_t ids[MAX_THREADS_SIM];
+    long long t0 = agoraNs();
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&ids[i], NULL, trabalharSimulacao, sim) != 0) {
+            fprintf(stderr, "Erro: nao foi possivel criar a thread %d.\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < threads; i++) pthread_join(ids[i], NULL);
+    long long t1 = agoraNs();
+
+    // Soma na ordem das partidas: o resumo nao depende do numero de threads
+    long pecas = 0, linhas = 0, derrotas = 0, acoes[TOTAL_ACOES] = {0};
+    for (int j = 0; j < sim->jogos; j++) {
+        ResultadoPartida *r = &sim->resultados[j];
+        pecas += r->pecas;
+        linhas += r->linhas;
+        derrotas += r->derrota;
+        for (int a = 0; a < TOTAL_ACOES; a++) acoes[a] += r->acoes[a];
+    }
+    double segundos = (t1 - t0) / 1e9;
+    printf("\nSimulacao: %d partidas, %d threads, ate %ld pecas, previsao %s\n",
+           sim->jogos, threads, sim->pecasMax, sim->previsao ? "sim" : "nao");
+    printf("Pecas: %ld  Linhas: %ld  Derrotas: %ld  Tempo: %.2f s\n", pecas, linhas, derrotas, segundos);
+    printf("Pecas/s: %.0f  Linhas por partida: %.1f\n", pecas / segundos, (double)linhas / sim->jogos);
+    printf("Acoes: jogar %ld, trocar topo %ld, troca multipla %ld, reservar %ld\n",
+           acoes[ACAO_JOGAR], acoes[ACAO_TROCAR_TOPO], acoes[ACAO_TROCA_MULTIPLA], acoes[ACAO_RESERVAR]);
+
+    free(sim->resultados);
+    sim->resultados = NULL;
+    return 1;
+}
+
+// ------------------------------------------------------------
+// Registro de eventos: gravacao e reproducao
+// ------------------------------------------------------------
+void descarregarRegistro(RegistroEventos *r) {
+    if (r->usado > 0 && fwrite(r->bloco, 1, r->usado, r->arquivo) != r->usado) r->erro = 1;
+    r->usado = 0;
+}
+
+// Grava a assinatura. Retorna 0 se faltar memoria ou a escrita falhar.
+int iniciarRegistro(RegistroEventos *r, FILE *arquivo) {
+    memset(r, 0, sizeof(*r));
+    r->arquivo = arquivo;
+    r->ultimoId = MASCARA_ID; // o primeiro id (0) conta como "anterior + 1"
+    r->bloco = (uint8_t*) malloc(REGISTRO_BLOCO);
+    if (!r->bloco) return 0;
+    return fwrite(REGISTRO_ASSINATURA, 1, 4, arquivo) == 4;
+}
+
+// Grava EVENTO_FIM, completa o ultimo byte com zeros, descarrega o bloco e
+// acrescenta o rodape. Nao fecha o arquivo. Retorna 0 se alguma escrita falhou.
+int finalizarRegistro(RegistroEventos *r) {
+    escreverBits(r, EVENTO_FIM, 3);
+    while (r->bits > 0) {
+        r->bloco[r->usado++] = (uint8_t)r->acumulador;
+        r->acumulador >>= 8;
+        r->bits -= r->bits > 8 ? 8 : r->bits;
+    }
+    descarregarRegistro(r);
+    uint8_t rodape[12];
+    memcpy(rodape, REGISTRO_RODAPE, 4);
+    for (int i = 0; i < 8; i++) rodape[4 + i] = (uint8_t)((uint64_t)r->eventos >> (8 * i));
+    if (fwrite(rodape, 1, sizeof(rodape), r->arquivo) != sizeof(rodape)) r->erro = 1;
+    if (fflush(r->arquivo) != 0) r->erro = 1;
+    free(r->bloco);
+    r->bloco = NULL;
+    return !r->erro;
+}
+
+// Gera uma peca nova no fim da fila e registra o evento
+void reporPeca(Fila *f, RegistroEventos *r) {
+    Peca nova = gerarPeca();
+    enqueue(f, nova);
+    registrarGerada(r, nova);
+}
+
+typedef struct {
+    FILE *arquivo;
+    uint8_t bloco[REGISTRO_BLOCO];
+    size_t tamanho, pos;
+    uint64_t acumulador;
+    int bits;
+    int fimArquivo;       // o arquivo acabou antes do que foi pedido
+} LeitorEventos;
+
+// No fim do arquivo devolve zeros (que decodificam como EVENTO_FIM) e
+// marca fimArquivo, para o rodape acusar o truncamento
+static inline uint32_t lerBits(LeitorEventos *l, int n) {
+    while (l->bits < n) {
+        if (l->pos == l->tamanho) {
+            l->tamanho = fread(l->bloco, 1, REGISTRO_BLOCO, l->arquivo);
+            l->pos = 0;
+            if (l->tamanho == 0) { l->fimArquivo = 1; l->bits = 64; break; }
+        }
+        l->acumulador |= (uint64_t)l->bloco[l->pos++] << l->bits;
+        l->bits += 8;
+    }
+    uint32_t v = (uint32_t)(l->acumulador & ((1ULL << n) - 1));
+    l->acumulador >>= n;
+    l->bits -= n;
+    return v;
+}
+
+static void aplicarJogada(Tabuleiro *t, Peca p, uint32_t rotacao, uint32_t coluna) {
+    if (t && colocarPeca(t, tipoPeca(p), (int)rotacao, (int)coluna) == FIM_DE_JOGO) limparTabuleiro(t);
+}
+
+/*
+  Reaplica os eventos [0, ate) do registro (todos se ate < 0) sobre f e p,
+  que devem comecar vazias e com crescimento ligado, e sobre t se nao for
+  NULL. Retorna o numero de eventos aplicados ou -1 se o registro for
+  invalido (assinatura errada, evento impossivel no estado atual ou, ao
+  ler ate o fim, rodape ausente ou com total diferente do lido).
+*/
+long reproduzirRegistro(FILE *arquivo, long ate, Fila *f, Pilha *p, Tabuleiro *t) {
+    char assinatura[4];
+    if (fread(assinatura, 1, 4, arquivo) != 4 || memcmp(assinatura, REGISTRO_ASSINATURA, 4) != 0) return -1;
+
+    LeitorEventos *l = (LeitorEventos*) malloc(sizeof(LeitorEventos));
+    if (!l) {
+        fprintf(stderr, "Erro: sem memoria para ler o registro.\n");
+        exit(EXIT_FAILURE);
+    }
+    l->arquivo = arquivo;
+    l->tamanho = l->pos = 0;
+    l->acumulador = 0;
+    l->bits = 0;
+    l->fimArquivo = 0;
+    if (t) limparTabuleiro(t);
+
+    uint32_t ultimoId = MASCARA_ID;
+    long n = 0;
+    int valido = 1;
+    while (valido && (ate < 0 || n < ate)) {
+        TipoEvento e = (TipoEvento) lerBits(l, 3);
+        if (e == EVENTO_FIM) {
+            // Descarta o preenchimento do byte e confere o rodape
+            lerBits(l, l->bits % 8);
+            char rodape[4];
+            for (int i = 0; i < 4; i++) rodape[i] = (char)lerBits(l, 8);
+            uint64_t total = lerBits(l, 32);
+            total |= (uint64_t)lerBits(l, 32) << 32;
+            valido = !l->fimArquivo && memcmp(rodape, REGISTRO_RODAPE, 4) == 0 && total == (uint64_t)n;
+            break;
+        }
+        switch (e) {
+        case EVENTO_GERADA: {
+            int tipo = (int)lerBits(l, 3);
+            uint32_t id = lerBits(l, 1) ? ((ultimoId + 1) & MASCARA_ID) : lerBits(l, 32 - BITS_TIPO);
+            valido = tipo < TOTAL_TIPOS && enqueue(f, criarPeca(tipo, id));
+            ultimoId = id;
+            break;
+        }
+        case EVENTO_JOGADA:
+        case EVENTO_USADA: {
+            uint32_t rotacao = lerBits(l, 2), coluna = lerBits(l, 4);
+            if (e == EVENTO_JOGADA ? filaVazia(f) : pilhaVazia(p)) { valido = 0; break; }
+            aplicarJogada(t, e == EVENTO_JOGADA ? dequeue(f) : pop(p), rotacao, coluna);
+            break;
+        }
+        case EVENTO_RESERVADA:
+            valido = !filaVazia(f) && push(p, dequeue(f));
+            break;
+        case EVENTO_TROCA_TOPO:
+            valido = trocarTopo(f, p);
+            break;
+        case EVENTO_DEVOLVIDA:
+            valido = !pilhaVazia(p) && enqueueFrente(f, pop(p));
+            break;
+        case EVENTO_TROCA_MULTIPLA: {
+            int bits = (int)lerBits(l, 5);
+            valido = bits > 0 && trocaMultipla(f, p, (int)lerBits(l, bits));
+            break;
+        }
+        default:
+            valido = 0;
+        }
+        if (valido) n++;
+    }
+    free(l);
+    return valido ? n : -1;
+}
+
+/*
+  Mede o custo de registrar: a mesma sequencia de operacoes (sorteada com
+  semente fixa) roda sem registro e com registro em um arquivo temporario.
+  Depois reproduz o arquivo e confere se fila e pilha batem.
+*/
+static long operacoesSorteadas(Fila *f, Pilha *p, Sorteador *s, RegistroEventos *reg, long eventos) {
+    long feitos = 0;
+    while (feitos < eventos) {
+        uint32_t op = sortearAte(s, 8);
+        Jogada j = {(int)(op & 3), (int)(op & 7)};
+        if (op < 4 || pilhaVazia(p)) {
+            dequeue(f);
+            registrarJogada(reg, EVENTO_JOGADA, j);
+        } else if (op < 6 && !pilhaCheia(p)) {
+            push(p, dequeue(f));
+            registrarEvento(reg, EVENTO_RESERVADA);
+        } else if (op == 6) {
+            trocarTopo(f, p);
+            registrarEvento(reg, EVENTO_TROCA_TOPO);
+        } else if (op == 7 && trocaMultipla(f, p, TROCA_PADRAO)) {
+            registrarTrocaMultipla(reg, TROCA_PADRAO);
+        } else {
+            pop(p);
+            registrarJogada(reg, EVENTO_USADA, j);
+        }
+        while (f->quantidade < ALVO_FILA(f)) {
+            Peca nova = proximaPeca(s);
+            enqueue(f, nova);
+            registrarGerada(reg, nova);
+            feitos++;
+        }
+        feitos++;
+    }
+    return feitos;
+}
+
+void benchmarkRegistro(void) {
+    long long tempo[2];
+    long eventos = 0;
+    Fila f;
+    Pilha p;
+    Sorteador s;
+    RegistroEventos r;
+    FILE *arq = tmpfile();
+    if (!arq) {
+        printf("Nao foi possivel criar o arquivo temporario.\n");
+        return;
+    }
+
+    for (int comRegistro = 0; comRegistro < 2; comRegistro++) {
+        inicializarFila(&f);
+        inicializarPilha(&p);
+        inicializarSorteador(&s, SORTEIO_SACO, 42);
+        if (comRegistro && !iniciarRegistro(&r, arq)) {
+            printf("Falha ao iniciar o registro.\n");
+            fclose(arq);
+            return;
+        }
+        RegistroEventos *reg = comRegistro ? &r : NULL;
+        completarFila(&f, &s);
+        for (int i = 0; i < f.quantidade; i++) registrarGerada(reg, pecaNaFila(&f, i));
+        long long t0 = agoraNs();
+        eventos = operacoesSorteadas(&f, &p, &s, reg, BENCH_REGISTRO_EVENTOS);
+        tempo[comRegistro] = agoraNs() - t0;
+    }
+    if (!finalizarRegistro(&r)) {
+        printf("Falha ao gravar o registro.\n");
+        fclose(arq);
+        return;
+    }
+    long bytes = ftell(arq);
+
+    Fila rf;
+    Pilha rp;
+    inicializarFilaCapacidade(&rf, TAM_FILA, 1);
+    inicializarPilhaCapacidade(&rp, TAM_PILHA, 1);
+    rewind(arq);
+    long lidos = reproduzirRegistro(arq, -1, &rf, &rp, NULL);
+    int confere = lidos == r.eventos && rf.quantidade == f.quantidade && rp.topo == p.topo;
+    for (int i = 0; confere && i < f.quantidade; i++)
+        confere = pecaNaFila(&rf, i).codigo == pecaNaFila(&f, i).codigo;
+    for (int i = 0; confere && i <= p.topo; i++)
+        confere = rp.itens[i].codigo == p.itens[i].codigo;
+    fclose(arq);
+    liberarFila(&rf);
+    liberarPilha(&rp);
 
-    printf("\n");
+    printf("\nRegistro: %ld eventos (%ld gravados), %.2f bytes/evento\n", eventos, r.eventos,
+           (double)bytes / r.eventos);
+    printf("Sem registro: %.2f ns/evento  Com registro: %.2f ns/evento  Custo: %.2f ns/evento\n",
+           (double)tempo[0] / eventos, (double)tempo[1] / eventos, (double)(tempo[1] - tempo[0]) / eventos);
+    printf("Reproducao: %ld eventos, estado final %s\n", lidos, confere ? "confere" : "DIVERGE");
 }